@@ -15,16 +15,37 @@
 #define LLVM_TRANSFORMS_231DFA_H
 
 #include "llvm/InitializePasses.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/IR/CFG.h"
 #include "llvm/IR/InstIterator.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <deque>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 #include <queue>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
 
 namespace llvm {
 
@@ -44,8 +65,9 @@ class Info {
      *
      * Direction:
      *   In your subclass you should implement this function according to the project specifications.
+     *   Write to OS, so that the output of different functions can be buffered separately.
      */
-    virtual void print() = 0;
+    virtual void print(raw_ostream & OS = errs()) = 0;
 
     /*
      * Compare two pieces of information
@@ -62,29 +84,721 @@ class Info {
      *   In your subclass you need to implement this function.
      */
     static Info* join(Info * info1, Info * info2, Info * result);
+    /*
+     * Hash a piece of information. Equal information must have equal hashes.
+     *
+     * Direction:
+     *   Only needed by analyses that enable hash consing.
+     */
+    static size_t hash(Info * info);
+    /*
+     * Apply a gen/kill summary: result = (in - kill) + gen.
+     * The fourth parameter may be the same object as the first one.
+     *
+     * Direction:
+     *   Only needed by analyses that run runBlockWorklistAlgorithm.
+     */
+    static void transfer(Info * in, Info * gen, Info * kill, Info * result);
+    /*
+     * Write a piece of information on one line, and read it back into result.
+     * deserialize returns false if the text is malformed.
+     *
+     * Direction:
+     *   Only needed with the persistent cache (-cse231-dfa-cache-dir).
+     */
+    static void serialize(Info * info, raw_ostream & OS);
+    static bool deserialize(StringRef text, Info * result);
+    /*
+     * Widening: result is above both old and next, and any sequence of widenings
+     * stabilizes in a finite number of steps. next is above old.
+     * Narrowing: result is between next and old, and any sequence of narrowings
+     * stabilizes in a finite number of steps. next is below old.
+     *
+     * Direction:
+     *   Only needed by analyses that run runWideningWorklistAlgorithm.
+     */
+    static void widen(Info * old, Info * next, Info * result);
+    static void narrow(Info * old, Info * next, Info * result);
+};
+
+/*
+ * Command line options shared by the passes built on the framework.
+ * The options are static members of a class template so that there is a
+ * single definition even if several passes include this header.
+ */
+template <class T = void>
+struct DFAOptionsBase {
+	static cl::opt<bool> PrintStats;
+	static cl::opt<bool> HashCons;
+	static cl::opt<bool> Compact;
+	static cl::opt<unsigned> Threads;
+	static cl::opt<bool> SCC;
+	static cl::opt<unsigned> SCCThreads;
+	static cl::opt<std::string> CacheDir;
+	static cl::opt<unsigned> CacheSize;
+	static cl::opt<std::string> StatsJSON;
+	static cl::opt<unsigned> TopSlowest;
+	static cl::opt<bool> WTO;
+	static cl::opt<unsigned> Narrowing;
+	static cl::opt<bool> Sparse;
+};
+
+template <class T>
+cl::opt<bool> DFAOptionsBase<T>::PrintStats("cse231-dfa-stats",
+		cl::desc("Print the statistics of the dataflow framework after each function"));
+
+template <class T>
+cl::opt<bool> DFAOptionsBase<T>::HashCons("cse231-dfa-hashcons",
+		cl::desc("Share identical edge information and memoize joins"));
+
+template <class T>
+cl::opt<bool> DFAOptionsBase<T>::Compact("cse231-dfa-compact",
+		cl::desc("Keep only the information on the edges into basic blocks after solving"));
+
+template <class T>
+cl::opt<unsigned> DFAOptionsBase<T>::Threads("cse231-dfa-threads",
+		cl::desc("Number of threads of the module-level passes (0: one per hardware thread)"),
+		cl::init(0));
+
+template <class T>
+cl::opt<bool> DFAOptionsBase<T>::SCC("cse231-dfa-scc",
+		cl::desc("Solve the strongly connected components of the edge graph in topological order"));
+
+template <class T>
+cl::opt<unsigned> DFAOptionsBase<T>::SCCThreads("cse231-dfa-scc-threads",
+		cl::desc("Number of threads to solve independent components (0: one per hardware thread)"),
+		cl::init(1));
+
+template <class T>
+cl::opt<std::string> DFAOptionsBase<T>::CacheDir("cse231-dfa-cache-dir",
+		cl::desc("Directory of the persistent cache of analysis results (empty: no cache)"),
+		cl::value_desc("directory"));
+
+template <class T>
+cl::opt<unsigned> DFAOptionsBase<T>::CacheSize("cse231-dfa-cache-size",
+		cl::desc("Size limit of the persistent cache in megabytes"),
+		cl::init(256));
+
+template <class T>
+cl::opt<std::string> DFAOptionsBase<T>::StatsJSON("cse231-dfa-stats-json",
+		cl::desc("Append the statistics of the dataflow framework to a file, one JSON object per function"),
+		cl::value_desc("filename"));
+
+template <class T>
+cl::opt<unsigned> DFAOptionsBase<T>::TopSlowest("cse231-dfa-top-slowest",
+		cl::desc("List the N functions of a module that took the longest to analyze"),
+		cl::value_desc("N"), cl::init(0));
+
+template <class T>
+cl::opt<bool> DFAOptionsBase<T>::WTO("cse231-dfa-wto",
+		cl::desc("Visit the basic blocks in weak topological order instead of a FIFO worklist"));
+
+template <class T>
+cl::opt<unsigned> DFAOptionsBase<T>::Narrowing("cse231-dfa-narrowing",
+		cl::desc("Number of narrowing passes after widening"),
+		cl::init(2));
+
+template <class T>
+cl::opt<bool> DFAOptionsBase<T>::Sparse("cse231-dfa-sparse",
+		cl::desc("Solve the set-of-facts analyses with runSparseAlgorithm"));
+
+typedef DFAOptionsBase<> DFAOptions;
+
+/*
+ * Statistics of the dataflow framework for one function.
+ */
+struct DFAStatistics {
+	// Info objects needed by the algorithm; each one used to be a heap allocation
+	unsigned InfoRequests = 0;
+	// Info objects actually allocated by the pool of the analysis
+	unsigned InfoAllocations = 0;
+	// Distinct pieces of information interned with hash consing
+	unsigned InternedInfos = 0;
+	// Joins answered from the join memo with hash consing
+	unsigned MemoizedJoins = 0;
+	// Instructions or basic blocks taken from the worklists
+	unsigned WorklistPops = 0;
+	// Pushes of instructions that were already in the worklist
+	unsigned RedundantPushes = 0;
+	// Calls of the flow function
+	unsigned FlowFunctionCalls = 0;
+	// Calls of Info::join and Info::equal by the framework
+	unsigned Joins = 0;
+	unsigned Equalities = 0;
+	// Updates that changed the information of an edge
+	unsigned ChangedEdges = 0;
+	// Largest number of Info objects of the pool in use at the same time.
+	// Their bytes only count sizeof(Info), not the storage of the containers inside.
+	unsigned PeakLiveInfos = 0;
+	// Demand-driven queries, and the instructions they had to solve
+	unsigned Queries = 0;
+	unsigned QuerySolved = 0;
+	// Wall time in seconds of the initialization of the edges, the solving and the printing
+	double InitTime = 0;
+	double SolveTime = 0;
+	double PrintTime = 0;
+};
+
+/*
+ * Add the wall time of its lifetime to *Seconds.
+ */
+class DFATimer {
+	std::chrono::steady_clock::time_point Start;
+	double * Seconds;
+
+  public:
+		DFATimer(double * seconds) : Start(std::chrono::steady_clock::now()), Seconds(seconds) {}
+
+		~DFATimer() {
+			*Seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		}
+};
+
+/*
+ * Reports of the statistics that cover more than one function:
+ * the JSON lines of -cse231-dfa-stats-json and the list of -cse231-dfa-top-slowest.
+ * Several threads may report at the same time.
+ */
+class DFAReport {
+		static std::mutex & lock() {
+			static std::mutex Lock;
+			return Lock;
+		}
+
+		// Seconds and name of the functions reported since the last list
+		static std::vector<std::pair<double, std::string>> & timings() {
+			static std::vector<std::pair<double, std::string>> Timings;
+			return Timings;
+		}
+
+  public:
+		/*
+		 * Report the statistics of function F.
+		 */
+		static void record(Function * F, const DFAStatistics & Stats, unsigned Instructions, size_t InfoBytes) {
+			double total = Stats.InitTime + Stats.SolveTime + Stats.PrintTime;
+			if (DFAOptions::TopSlowest > 0) {
+				std::lock_guard<std::mutex> guard(lock());
+				timings().push_back(std::make_pair(total, F->getName().str()));
+			}
+			if (DFAOptions::StatsJSON.empty())
+				return;
+
+			std::string line;
+			raw_string_ostream OS(line);
+			OS << "{\"function\": \"";
+			for (char c : F->getName()) {
+				if (c == '"' || c == '\\')
+					OS << '\\' << c;
+				else if ((unsigned char)c < 0x20)
+					OS << format("\\u%04x", (unsigned char)c);
+				else
+					OS << c;
+			}
+			OS << "\", \"instructions\": " << Instructions
+				 << ", \"worklist_pops\": " << Stats.WorklistPops
+				 << ", \"redundant_pushes\": " << Stats.RedundantPushes
+				 << ", \"flow_function_calls\": " << Stats.FlowFunctionCalls
+				 << ", \"joins\": " << Stats.Joins
+				 << ", \"equalities\": " << Stats.Equalities
+				 << ", \"changed_edges\": " << Stats.ChangedEdges
+				 << ", \"info_requests\": " << Stats.InfoRequests
+				 << ", \"info_allocations\": " << Stats.InfoAllocations
+				 << ", \"peak_live_infos\": " << Stats.PeakLiveInfos
+				 << ", \"peak_live_bytes\": " << (uint64_t)Stats.PeakLiveInfos * InfoBytes
+				 << ", \"queries\": " << Stats.Queries
+				 << ", \"query_solved\": " << Stats.QuerySolved
+				 << ", \"init_seconds\": " << format("%.6f", Stats.InitTime)
+				 << ", \"solve_seconds\": " << format("%.6f", Stats.SolveTime)
+				 << ", \"print_seconds\": " << format("%.6f", Stats.PrintTime)
+				 << "}\n";
+			OS.flush();
+
+			// One write per line, so the lines of concurrent processes do not interleave
+			std::lock_guard<std::mutex> guard(lock());
+			std::error_code ec;
+			raw_fd_ostream file(DFAOptions::StatsJSON, ec, sys::fs::OF_Append);
+			if (!ec)
+				file << line;
+		}
+
+		/*
+		 * Print the -cse231-dfa-top-slowest functions reported since the last call.
+		 */
+		static void printSlowest(raw_ostream & OS = errs()) {
+			std::lock_guard<std::mutex> guard(lock());
+			std::vector<std::pair<double, std::string>> & list = timings();
+			if (DFAOptions::TopSlowest == 0 || list.empty())
+				return;
+			std::stable_sort(list.begin(), list.end(), [](const std::pair<double, std::string> & a,
+																										 const std::pair<double, std::string> & b) {
+				return a.first > b.first;
+			});
+			OS << "Slowest functions:\n";
+			for (int i = 0; i < list.size() && i < DFAOptions::TopSlowest; ++i)
+				OS << format("%10.6f s  ", list[i].first) << list[i].second << "\n";
+			list.clear();
+		}
+};
+
+/*
+ * Persistent cache of analysis results in -cse231-dfa-cache-dir, one file per key.
+ *   Files are written under a temporary name and renamed into place, so several
+ *   processes can share the directory and a reader never sees a partial file.
+ *   A hit refreshes the modification time of the file. When the directory grows over
+ *   -cse231-dfa-cache-size, the files that were least recently used are removed.
+ */
+class DFACache {
+  public:
+		// Bump when the format of the files changes
+		static const unsigned Version = 1;
+		// Prune the directory after this many stores in a process
+		static const unsigned PruneInterval = 64;
+
+		/*
+		 * Hash the IR of F together with the ID of the analysis.
+		 */
+		static std::string key(Function * F, StringRef AnalysisID) {
+			std::string text;
+			raw_string_ostream OS(text);
+			OS << "cse231-dfa-cache " << Version << " " << AnalysisID << "\n";
+			F->print(OS);
+			OS.flush();
+
+			MD5 hash;
+			hash.update(text);
+			MD5::MD5Result result;
+			hash.final(result);
+			SmallString<32> hex;
+			MD5::stringifyResult(result, hex);
+			return ("cse231-" + hex).str();
+		}
+
+		/*
+		 * Read the file of key into content. Return false on a miss.
+		 */
+		static bool load(StringRef key, std::string * content) {
+			SmallString<128> path(DFAOptions::CacheDir);
+			sys::path::append(path, key);
+			ErrorOr<std::unique_ptr<MemoryBuffer>> buffer = MemoryBuffer::getFile(path);
+			if (!buffer)
+				return false;
+			*content = (*buffer)->getBuffer().str();
+
+			int fd;
+			if (!sys::fs::openFileForWrite(path, fd, sys::fs::CD_OpenExisting, sys::fs::OF_Append)) {
+				sys::fs::setLastAccessAndModificationTime(fd,
+						std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now()));
+				sys::Process::SafelyCloseFileDescriptor(fd);
+			}
+			return true;
+		}
+
+		/*
+		 * Write content as the file of key. Failures only mean the result is not cached.
+		 */
+		static void store(StringRef key, StringRef content) {
+			StringRef dir = DFAOptions::CacheDir;
+			if (sys::fs::create_directories(dir))
+				return;
+
+			int fd;
+			SmallString<128> model(dir), temp;
+			sys::path::append(model, key + "-%%%%%%%%.tmp");
+			if (sys::fs::createUniqueFile(model, fd, temp))
+				return;
+			{
+				raw_fd_ostream OS(fd, true);
+				OS << content;
+				OS.close();
+				if (OS.has_error()) {
+					OS.clear_error();
+					sys::fs::remove(temp);
+					return;
+				}
+			}
+
+			SmallString<128> path(dir);
+			sys::path::append(path, key);
+			if (sys::fs::rename(temp, path))
+				sys::fs::remove(temp);
+
+			static std::atomic<unsigned> stores(0);
+			if (stores++ % PruneInterval == 0)
+				prune();
+		}
+
+		/*
+		 * Remove the least recently used files until the directory fits in -cse231-dfa-cache-size.
+		 * Temporary files left behind by crashed processes are removed after an hour.
+		 * Another process may remove the same files at the same time, so errors are ignored.
+		 */
+		static void prune() {
+			typedef std::chrono::system_clock::time_point TimePoint;
+			std::vector<std::pair<TimePoint, std::pair<uint64_t, std::string>>> files;
+			uint64_t total = 0;
+			TimePoint stale = std::chrono::system_clock::now() - std::chrono::hours(1);
+
+			std::error_code ec;
+			for (sys::fs::directory_iterator it(DFAOptions::CacheDir, ec), end; it != end && !ec; it.increment(ec)) {
+				StringRef name = sys::path::filename(it->path());
+				sys::fs::file_status status;
+				if (!name.startswith("cse231-") || sys::fs::status(it->path(), status) || !sys::fs::is_regular_file(status))
+					continue;
+				TimePoint modified = status.getLastModificationTime();
+				if (name.endswith(".tmp")) {
+					if (modified < stale)
+						sys::fs::remove(it->path());
+					continue;
+				}
+				files.push_back(std::make_pair(modified, std::make_pair(status.getSize(), it->path())));
+				total += status.getSize();
+			}
+
+			uint64_t limit = (uint64_t)DFAOptions::CacheSize << 20;
+			std::sort(files.begin(), files.end());
+			for (int i = 0; i < files.size() && total > limit; ++i) {
+				sys::fs::remove(files[i].second.second);
+				total -= files[i].second.first;
+			}
+		}
+};
+
+/*
+ * Run task(0), ..., task(n - 1) on a pool of threads (0: one per hardware thread).
+ * The threads take the tasks in order from a shared counter, so a long task does not hold up the others.
+ */
+template <class Task>
+void parallelFor(unsigned n, unsigned threads, Task task) {
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+	threads = std::max(1u, std::min(threads, n));
+	if (threads == 1) {
+		for (unsigned i = 0; i < n; ++i)
+			task(i);
+		return;
+	}
+
+	std::atomic<unsigned> next(0);
+	std::vector<std::thread> workers;
+	for (unsigned t = 0; t < threads; ++t) {
+		workers.emplace_back([&]() {
+			for (unsigned i = next++; i < n; i = next++)
+				task(i);
+		});
+	}
+	for (std::thread & worker : workers)
+		worker.join();
+}
+
+/*
+ * Run the tasks of a DAG on a pool of threads with work stealing (0: one per hardware thread).
+ *   Succs[i]: the tasks that depend on task i. Every task must come before its successors in the numbering.
+ * A task becomes ready when all the tasks it depends on are done. Each thread keeps the tasks
+ * it makes ready in its own deque, runs the newest one first, and steals the oldest task of
+ * another thread when its deque is empty.
+ */
+template <class Task>
+void runTaskGraph(const std::vector<std::vector<unsigned>> & Succs, unsigned threads, Task task) {
+	unsigned n = Succs.size();
+	std::vector<unsigned> preds(n, 0);
+	for (const std::vector<unsigned> & next : Succs) {
+		for (unsigned s : next)
+			++preds[s];
+	}
+
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+	threads = std::max(1u, std::min(threads, n));
+	if (threads == 1) {
+		for (unsigned i = 0; i < n; ++i)
+			task(i);
+		return;
+	}
+
+	std::vector<std::atomic<unsigned>> pending(n);
+	std::vector<std::deque<unsigned>> deques(threads);
+	std::vector<std::mutex> locks(threads);
+	std::atomic<unsigned> remaining(n);
+	for (unsigned i = 0, t = 0; i < n; ++i) {
+		pending[i] = preds[i];
+		if (preds[i] == 0)
+			deques[t++ % threads].push_back(i);
+	}
+
+	auto worker = [&](unsigned self) {
+		while (remaining > 0) {
+			bool found = false;
+			unsigned i = 0;
+			{
+				std::lock_guard<std::mutex> guard(locks[self]);
+				if (!deques[self].empty()) {
+					i = deques[self].back();
+					deques[self].pop_back();
+					found = true;
+				}
+			}
+			for (unsigned k = 1; k < threads && !found; ++k) {
+				unsigned victim = (self + k) % threads;
+				std::lock_guard<std::mutex> guard(locks[victim]);
+				if (!deques[victim].empty()) {
+					i = deques[victim].front();
+					deques[victim].pop_front();
+					found = true;
+				}
+			}
+			if (!found) {
+				std::this_thread::yield();
+				continue;
+			}
+
+			task(i);
+			for (unsigned s : Succs[i]) {
+				if (--pending[s] == 0) {
+					std::lock_guard<std::mutex> guard(locks[self]);
+					deques[self].push_back(s);
+				}
+			}
+			--remaining;
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned t = 0; t < threads; ++t)
+		workers.emplace_back(worker, t);
+	for (std::thread & thread : workers)
+		thread.join();
+}
+
+/*
+ * Compute the strongly connected components of a graph of n nodes with Tarjan's algorithm.
+ *   Succs: the sorted successors of each node; nodes without successors may be missing.
+ *   SCCOf stores the component of each node. The components are numbered in topological order.
+ *   Return the number of components.
+ */
+inline unsigned computeSCCs(unsigned n, const std::map<unsigned, std::vector<unsigned>> & Succs,
+														std::vector<unsigned> * SCCOf) {
+	const unsigned unvisited = ~0u;
+	std::vector<unsigned> order(n, unvisited), low(n), stack;
+	std::vector<bool> onStack(n, false);
+	// Explicit call stack of (node, position of the next successor)
+	std::vector<std::pair<unsigned, unsigned>> frames;
+	unsigned counter = 0, components = 0;
+
+	SCCOf->assign(n, 0);
+	for (unsigned root = 0; root < n; ++root) {
+		if (order[root] != unvisited)
+			continue;
+		order[root] = low[root] = counter++;
+		stack.push_back(root);
+		onStack[root] = true;
+		frames.push_back(std::make_pair(root, 0));
+
+		while (!frames.empty()) {
+			unsigned v = frames.back().first;
+			auto it = Succs.find(v);
+			if (it != Succs.end() && frames.back().second < it->second.size()) {
+				unsigned w = it->second[frames.back().second++];
+				if (order[w] == unvisited) {
+					order[w] = low[w] = counter++;
+					stack.push_back(w);
+					onStack[w] = true;
+					frames.push_back(std::make_pair(w, 0));
+				} else if (onStack[w]) {
+					low[v] = std::min(low[v], order[w]);
+				}
+				continue;
+			}
+
+			frames.pop_back();
+			if (!frames.empty())
+				low[frames.back().first] = std::min(low[frames.back().first], low[v]);
+			if (low[v] == order[v]) {
+				unsigned w;
+				do {
+					w = stack.back();
+					stack.pop_back();
+					onStack[w] = false;
+					(*SCCOf)[w] = components;
+				} while (w != v);
+				++components;
+			}
+		}
+	}
+
+	// Tarjan's algorithm finds the components in reverse topological order
+	for (unsigned & c : *SCCOf)
+		c = components - 1 - c;
+	return components;
+}
+
+/*
+ * The function called directly by a call or invoke instruction, or nullptr.
+ */
+inline Function * getCalledFunction(Instruction * I) {
+	if (CallInst *call = dyn_cast<CallInst>(I))
+		return call->getCalledFunction();
+	if (InvokeInst *invoke = dyn_cast<InvokeInst>(I))
+		return invoke->getCalledFunction();
+	return nullptr;
+}
+
+/*
+ * A std::map that several analyses can use at the same time: after share, both
+ * objects are views of the same map, without copying it. The components of a
+ * ProductAnalysis use the indices of the product this way.
+ */
+template <class Key, class Value>
+class SharedMap {
+	std::shared_ptr<std::map<Key, Value>> Map;
+
+  public:
+		typedef typename std::map<Key, Value>::iterator iterator;
+		typedef typename std::map<Key, Value>::const_iterator const_iterator;
+
+		SharedMap() : Map(std::make_shared<std::map<Key, Value>>()) {}
+
+		void share(const SharedMap & other) {
+			Map = other.Map;
+		}
+
+		Value & operator[](const Key & key) {
+			return (*Map)[key];
+		}
+
+		iterator find(const Key & key) {
+			return Map->find(key);
+		}
+
+		size_t count(const Key & key) const {
+			return Map->count(key);
+		}
+
+		iterator begin() {
+			return Map->begin();
+		}
+
+		iterator end() {
+			return Map->end();
+		}
+
+		const_iterator begin() const {
+			return Map->begin();
+		}
+
+		const_iterator end() const {
+			return Map->end();
+		}
+
+		size_t size() const {
+			return Map->size();
+		}
+
+		bool empty() const {
+			return Map->empty();
+		}
+
+		void clear() {
+			Map->clear();
+		}
 };
 
+template <class AnalysisA, class AnalysisB>
+class ProductAnalysis;
+
 /*
  * This is the base template class to represent the generic dataflow analysis framework
  * For a specific analysis, you need to create a sublcass of it.
+ *
+ * Derived is optional. If a subclass passes itself as Derived (CRTP), the solver
+ * calls its flowfunction and summarize directly instead of through the vtable;
+ * the subclass must then make DataFlowAnalysis a friend.
  */
-template <class Info, bool Direction>
+template <class Info, bool Direction, class Derived = void>
 class DataFlowAnalysis {
+	// A product solves its components on its own edge graph
+	template <class AnalysisA, class AnalysisB>
+	friend class ProductAnalysis;
+
+  public:
+		typedef Info InfoType;
+		static const bool AnalysisDirection = Direction;
 
   protected:
 		typedef std::pair<unsigned, unsigned> Edge;
 		// Index to instruction map
-		std::map<unsigned, Instruction *> IndexToInstr;
+		SharedMap<unsigned, Instruction *> IndexToInstr;
 		// Instruction to index map
-		std::map<Instruction *, unsigned> InstrToIndex;
+		SharedMap<Instruction *, unsigned> InstrToIndex;
 		// Edge to information map
 		std::map<Edge, Info *> EdgeToInfo;
+		// Set by a product on its components: their part of the information of its edges
+		std::function<Info * (unsigned, unsigned)> EdgeView;
+		// Index to sorted source indices of its incoming edges
+		std::map<unsigned, std::vector<unsigned>> IndexToIncoming;
+		// Index to sorted destination indices of its outgoing edges
+		std::map<unsigned, std::vector<unsigned>> IndexToOutgoing;
 		// The bottom of the lattice
     Info Bottom;
     // The initial state of the analysis
 		Info InitialState;
 		// EntryInstr points to the first instruction to be processed in the analysis
 		Instruction * EntryInstr;
+		// All Info objects allocated by the analysis. They are deleted with the analysis.
+		std::vector<Info *> InfoPool;
+		// Info objects of InfoPool that are free to be reused
+		std::vector<Info *> FreeInfos;
+		// Scratch storage for the joins in updateEdge
+		Info Scratch;
+		// Statistics of the framework
+		DFAStatistics Stats;
+		// With hash consing, every edge points to an immutable canonical Info object
+		// and identical information is shared by all the edges that carry it.
+		bool HashConsing;
+		// Hash to the canonical Info objects with that hash
+		std::unordered_map<size_t, std::vector<Info *>> InternTable;
+		// Canonical Info object to its ID
+		std::unordered_map<Info *, unsigned> InfoToID;
+		// Pair of IDs to the canonical result of their join
+		std::map<std::pair<unsigned, unsigned>, Info *> JoinMemo;
+		// The canonical bottom with hash consing
+		Info * CanonicalBottom;
+		// In compact mode, only the edges into basic blocks keep their information after solving.
+		// The edges inside a block are recomputed on demand from the edges into it.
+		bool CompactResults;
+		// The basic block whose inside edges are currently recomputed in compact mode
+		BasicBlock * ExpandedBlock;
+		// After runSparseAlgorithm, the facts entering each basic block whose edges are not built yet
+		std::unordered_map<BasicBlock *, std::vector<unsigned>> SparseBlocks;
+		// Solve the strongly connected components of the edge graph one by one
+		bool SCCSolving;
+		// True while components are solved by several threads
+		bool Concurrent;
+		// Serializes the pool, the statistics and hash consing while Concurrent is true
+		std::recursive_mutex SharedLock;
+		// Number of times each index is in the worklist of its component, for the statistics
+		std::vector<unsigned> Queued;
+		// Visit the basic blocks in weak topological order in runWorklistAlgorithm
+		bool WTOSolving;
+		// Weak topological order of the basic blocks in analysis order, see computeWTO.
+		// End is 0 for a single block, and one past the last element for the head of a component.
+		struct WTOElement {
+			BasicBlock * Block;
+			unsigned End;
+		};
+		std::vector<WTOElement> WTO;
+		// Indices whose outgoing edges are final, for the demand-driven queries
+		std::vector<bool> Solved;
+		// Indices of the first instructions of the heads of the components, where widening is applied
+		std::vector<bool> WideningPoint;
+		// Indices whose incoming information changed since the head of their component was visited
+		std::vector<bool> Dirty;
+		// ID and version of the analysis in the keys of the persistent cache. Empty: not cached.
+		std::string CacheID;
+		// Key of the function being solved in the persistent cache
+		std::string CacheKey;
+		// Summaries of the functions of the module in interprocedural mode, see runInterprocedural
+		const std::map<Function *, Info> * Summaries;
 
 
 		/*
@@ -125,10 +839,9 @@ class DataFlowAnalysis {
 		void getIncomingEdges(unsigned index, std::vector<unsigned> * IncomingEdges) {
 			assert(IncomingEdges->size() == 0 && "IncomingEdges should be empty.");
 
-			for (auto const &it : EdgeToInfo) {
-				if (it.first.second == index)
-					IncomingEdges->push_back(it.first.first);
-			}
+			auto it = IndexToIncoming.find(index);
+			if (it != IndexToIncoming.end())
+				*IncomingEdges = it->second;
 
 			return;
 		}
@@ -141,10 +854,9 @@ class DataFlowAnalysis {
 		void getOutgoingEdges(unsigned index, std::vector<unsigned> * OutgoingEdges) {
 			assert(OutgoingEdges->size() == 0 && "OutgoingEdges should be empty.");
 
-			for (auto const &it : EdgeToInfo) {
-				if (it.first.first == index)
-					OutgoingEdges->push_back(it.first.second);
-			}
+			auto it = IndexToOutgoing.find(index);
+			if (it != IndexToOutgoing.end())
+				*OutgoingEdges = it->second;
 
 			return;
 		}
@@ -156,8 +868,14 @@ class DataFlowAnalysis {
 		 */
 		void addEdge(Instruction * src, Instruction * dst, Info * content) {
 			Edge edge = std::make_pair(InstrToIndex[src], InstrToIndex[dst]);
-			if (EdgeToInfo.count(edge) == 0)
+			if (EdgeToInfo.count(edge) == 0) {
 				EdgeToInfo[edge] = content;
+				// Keep the adjacency lists sorted, i.e. in the same order as EdgeToInfo
+				std::vector<unsigned> & srcs = IndexToIncoming[edge.second];
+				srcs.insert(std::lower_bound(srcs.begin(), srcs.end(), edge.first), edge.first);
+				std::vector<unsigned> & dsts = IndexToOutgoing[edge.first];
+				dsts.insert(std::lower_bound(dsts.begin(), dsts.end(), edge.second), edge.second);
+			}
 			return;
 		}
 
@@ -265,110 +983,1948 @@ class DataFlowAnalysis {
 			return;
 		}
 
-    /*
-     * The flow function.
-     *   Instruction I: the IR instruction to be processed.
-     *   std::vector<unsigned> & IncomingEdges: the vector of the indices of the source instructions of the incoming edges.
-     *   std::vector<unsigned> & IncomingEdges: the vector of indices of the source instructions of the outgoing edges.
-     *   std::vector<Info *> & Infos: the vector of the newly computed information for each outgoing eages.
-     *
-     * Direction:
-     * 	 Implement this function in subclasses.
-     */
-    virtual void flowfunction(Instruction * I,
-    													std::vector<unsigned> & IncomingEdges,
-															std::vector<unsigned> & OutgoingEdges,
-															std::vector<Info *> & Infos) = 0;
+		/*
+		 * Utility function:
+		 *   The information on the edge src->dst, for the flow functions to join their incoming edges.
+		 *   In a component of a product, it is the part of the component in the edge of the product.
+		 */
+		Info * edgeInfo(unsigned src, unsigned dst) {
+			if (EdgeView)
+				return EdgeView(src, dst);
+			return EdgeToInfo[std::make_pair(src, dst)];
+		}
 
-  public:
-    DataFlowAnalysis(Info & bottom, Info & initialState) :
-    								 Bottom(bottom), InitialState(initialState),EntryInstr(nullptr) {}
+		/*
+		 * Utility function:
+		 *   Use the indices of another analysis of the same function instead of building them.
+		 *   A product does this for its components, see ProductAnalysis.
+		 */
+		virtual void useIndices(const SharedMap<unsigned, Instruction *> & indexToInstr,
+														const SharedMap<Instruction *, unsigned> & instrToIndex) {
+			IndexToInstr.share(indexToInstr);
+			InstrToIndex.share(instrToIndex);
+		}
 
-    virtual ~DataFlowAnalysis() {}
+		/*
+		 * Utility function:
+		 *   Set Concurrent while the SCC solver runs components in parallel.
+		 *   A product also sets it on its components, whose flow functions then run in parallel too.
+		 */
+		virtual void setConcurrent(bool concurrent) {
+			Concurrent = concurrent;
+		}
 
-    /*
-     * Print out the analysis results.
-     *
-     * Direction:
-     * 	 Do not change this funciton.
-     * 	 The autograder will check the output of this function.
-     */
-    void print() {
-			for (auto const &it : EdgeToInfo) {
-				errs() << "Edge " << it.first.first << "->" "Edge " << it.first.second << ":";
-				(it.second)->print();
+		/*
+		 * Utility function:
+		 *   Lock SharedLock, but only while Concurrent is set; otherwise the lock is not taken.
+		 */
+		std::unique_lock<std::recursive_mutex> lockShared() {
+			std::unique_lock<std::recursive_mutex> lock(SharedLock, std::defer_lock);
+			if (Concurrent)
+				lock.lock();
+			return lock;
+		}
+
+		/*
+		 * Utility function:
+		 *   Get an empty Info object from the pool of the analysis.
+		 *   The object is owned by the analysis; give it back with releaseInfo.
+		 */
+		Info * acquireInfo() {
+			auto lock = lockShared();
+			++Stats.InfoRequests;
+			if (FreeInfos.empty()) {
+				++Stats.InfoAllocations;
+				InfoPool.push_back(new Info());
+				Stats.PeakLiveInfos = std::max<unsigned>(Stats.PeakLiveInfos, InfoPool.size() - FreeInfos.size());
+				return InfoPool.back();
 			}
-    }
+			Info *info = FreeInfos.back();
+			FreeInfos.pop_back();
+			Stats.PeakLiveInfos = std::max<unsigned>(Stats.PeakLiveInfos, InfoPool.size() - FreeInfos.size());
+			return info;
+		}
 
-    /*
-     * This function implements the work list algorithm in the following steps:
-     * (1) Initialize info of each edge to bottom
-     * (2) Initialize the worklist
-     * (3) Compute until the worklist is empty
-     *
-     * Direction:
-     *   Implement the rest of the function.
-     *   You may not change anything before "// (2) Initialize the worklist".
-     */
-    void runWorklistAlgorithm(Function * func) {
-    	std::deque<unsigned> worklist;
+		/*
+		 * Utility function:
+		 *   Clear an Info object from acquireInfo and return it to the pool.
+		 */
+		void releaseInfo(Info * info) {
+			auto lock = lockShared();
+			*info = Info();
+			FreeInfos.push_back(info);
+		}
 
-    	// (1) Initialize info of each edge to bottom
-    	if (Direction)
-    		initializeForwardMap(func);
-    	else
-    		initializeBackwardMap(func);
+		/*
+		 * Utility function:
+		 *   Get the canonical Info object equal to info.
+		 *   If there is none yet, the content of info is moved into a new canonical object.
+		 */
+		Info * intern(Info * info) {
+			std::vector<Info *> & bucket = InternTable[Info::hash(info)];
+			for (Info *canonical : bucket) {
+				++Stats.Equalities;
+				if (Info::equal(canonical, info))
+					return canonical;
+			}
 
-    	assert(EntryInstr != nullptr && "Entry instruction is null.");
+			Info *canonical = acquireInfo();
+			std::swap(*canonical, *info);
+			bucket.push_back(canonical);
+			InfoToID[canonical] = Stats.InternedInfos++;
+			return canonical;
+		}
 
-    	// (2) Initialize the work list
-		for (auto iter = IndexToInstr.begin(); iter != IndexToInstr.end(); ++iter)
-			worklist.push_back(iter->first);
+		/*
+		 * Utility function:
+		 *   Join two canonical Info objects. The result is canonical and memoized by the pair of IDs.
+		 */
+		Info * joinCanonical(Info * info1, Info * info2) {
+			if (info1 == info2)
+				return info1;
 
-    	// (3) Compute until the work list is empty
-		while (!worklist.empty()) {
-			
-			// 3.1 get index of current instruction 
-			unsigned index = worklist.front();
-			Instruction *instr = IndexToInstr[index];
-			worklist.pop_front();
-			
-			// 3.2 get incoming and outgoing edges of current instruction
-			std::vector<unsigned> incoming_edges, outgoing_edges;
-			getIncomingEdges(index, &incoming_edges);
-			getOutgoingEdges(index, &outgoing_edges);
-			
-			
-			// 3.3 call flow function, calculate new outgoing information
+			unsigned id1 = InfoToID[info1], id2 = InfoToID[info2];
+			std::pair<unsigned, unsigned> key = std::make_pair(std::min(id1, id2), std::max(id1, id2));
+			auto it = JoinMemo.find(key);
+			if (it != JoinMemo.end()) {
+				++Stats.MemoizedJoins;
+				return it->second;
+			}
+
+			Scratch = *info1;
+			Info::join(&Scratch, info2, &Scratch);
+			++Stats.Joins;
+			Info *result = intern(&Scratch);
+			JoinMemo[key] = result;
+			return result;
+		}
+
+		/*
+		 * Utility function:
+		 *   Replace the initial information of every edge by its canonical object.
+		 */
+		void internEdges() {
+			Info bottom = Bottom, initialState = InitialState;
+			CanonicalBottom = intern(&bottom);
+			Info *canonicalInitialState = intern(&initialState);
+			for (auto &it : EdgeToInfo)
+				it.second = (it.second == &InitialState) ? canonicalInitialState : CanonicalBottom;
+		}
+
+		/*
+		 * Utility function:
+		 *   Join info into the information of the edge src->dst.
+		 *   Return true if the information of the edge changed.
+		 *   The join is computed in the scratch storage and swapped into the edge if it differs.
+		 */
+		bool updateEdge(unsigned src, unsigned dst, Info * info) {
+			Info *& edgeInfo = EdgeToInfo.find(std::make_pair(src, dst))->second;
+
+			// Canonical objects are immutable: compare by pointer and point the edge to the join
+			if (HashConsing) {
+				auto lock = lockShared();
+				Info *joined = joinCanonical(edgeInfo, intern(info));
+				if (joined == edgeInfo)
+					return false;
+				edgeInfo = joined;
+				return true;
+			}
+
+			// Components solved in parallel cannot share the scratch storage
+			Info local;
+			Info *scratch = Concurrent ? &local : &Scratch;
+			{
+				auto lock = lockShared();
+				++Stats.InfoRequests;
+				++Stats.Joins;
+				++Stats.Equalities;
+			}
+			*scratch = *edgeInfo;
+			Info::join(scratch, info, scratch);
+			if (Info::equal(scratch, edgeInfo))
+				return false;
+
+			// Bottom and InitialState are shared by many edges
+			if (edgeInfo == &Bottom || edgeInfo == &InitialState)
+				edgeInfo = acquireInfo();
+			std::swap(*edgeInfo, *scratch);
+			return true;
+		}
+
+		/*
+		 * Utility function:
+		 *   Apply the flow function to the instruction identified by index
+		 *   and update the information of its outgoing edges.
+		 *   Changed stores the destination indices of the edges whose information changed.
+		 */
+		void processInstr(unsigned index, std::vector<unsigned> * Changed) {
+			processInstr(index, Changed, [this](unsigned src, unsigned dst, Info * info) {
+				return updateEdge(src, dst, info);
+			});
+		}
+
+		/*
+		 * Utility function:
+		 *   processInstr, with update(src, dst, info) instead of updateEdge.
+		 */
+		template <class Update>
+		void processInstr(unsigned index, std::vector<unsigned> * Changed, Update update) {
+			Instruction *instr = IndexToInstr[index];
+
+			// get incoming and outgoing edges of current instruction
+			std::vector<unsigned> incoming_edges, outgoing_edges;
+			getIncomingEdges(index, &incoming_edges);
+			getOutgoingEdges(index, &outgoing_edges);
+
+			// call flow function, calculate new outgoing information
 			std::vector<Info *> infos(outgoing_edges.size());
 			for (int i = 0; i < infos.size(); ++i)
-				infos[i] = new Info();
-			flowfunction(instr, incoming_edges, outgoing_edges, infos);
+				infos[i] = acquireInfo();
+			callFlowFunction(instr, incoming_edges, outgoing_edges, infos);
 
-			
-			// 3.4 update edge information and add instructions with changed incoming information to the worklist
+			// update edge information
+			unsigned changed = 0;
 			for (int i = 0; i < outgoing_edges.size(); ++i) {
-				unsigned src = index, dst = outgoing_edges[i];
-				Edge e = std::make_pair(src, dst);
-
-				Info *newinfo = Info::join(EdgeToInfo[e], infos[i], nullptr);
-				if (!Info::equal(newinfo, EdgeToInfo[e])) {
-					if (EdgeToInfo[e] == &Bottom)
-						EdgeToInfo[e] = Info::join(EdgeToInfo[e], infos[i], nullptr);
-					else
-						Info::join(EdgeToInfo[e], infos[i], EdgeToInfo[e]);
-					worklist.push_back(dst);
+				if (update(index, outgoing_edges[i], infos[i])) {
+					Changed->push_back(outgoing_edges[i]);
+					++changed;
 				}
-				delete newinfo;
+			}
+			{
+				auto lock = lockShared();
+				++Stats.FlowFunctionCalls;
+				Stats.ChangedEdges += changed;
 			}
 
 			for (int i = 0; i < infos.size(); ++i)
-				delete infos[i];
+				releaseInfo(infos[i]);
+		}
+
+		/*
+		 * Utility function:
+		 *   Replace the information of the edge src->dst by info.
+		 *   Return true if the information of the edge changed.
+		 */
+		bool replaceEdge(unsigned src, unsigned dst, Info * info) {
+			Info *& edgeInfo = EdgeToInfo.find(std::make_pair(src, dst))->second;
+			++Stats.Equalities;
+			if (Info::equal(edgeInfo, info))
+				return false;
+			if (HashConsing) {
+				edgeInfo = intern(info);
+				return true;
+			}
+			if (edgeInfo == &Bottom || edgeInfo == &InitialState)
+				edgeInfo = acquireInfo();
+			std::swap(*edgeInfo, *info);
+			return true;
+		}
+
+		/*
+		 * Utility function:
+		 *   Like updateEdge, but widen the information of the edge src->dst with its join with info.
+		 */
+		bool widenEdge(unsigned src, unsigned dst, Info * info) {
+			Info *edgeInfo = EdgeToInfo.find(std::make_pair(src, dst))->second;
+			Info joined = *edgeInfo, widened;
+			Info::join(&joined, info, &joined);
+			++Stats.Joins;
+			Info::widen(edgeInfo, &joined, &widened);
+			return replaceEdge(src, dst, &widened);
+		}
+
+		/*
+		 * Utility function:
+		 *   Narrow the information of the edge src->dst with info.
+		 */
+		bool narrowEdge(unsigned src, unsigned dst, Info * info) {
+			Info *edgeInfo = EdgeToInfo.find(std::make_pair(src, dst))->second;
+			Info narrowed;
+			Info::narrow(edgeInfo, info, &narrowed);
+			return replaceEdge(src, dst, &narrowed);
+		}
+
+		/*
+		 * Utility function:
+		 *   Get the indices of the instructions of a basic block that have edges, in analysis order.
+		 *   Only the first phi node of a block has edges, see initializeForwardMap.
+		 */
+		void getBlockNodes(BasicBlock * block, std::vector<unsigned> * Nodes) {
+			assert(Nodes->size() == 0 && "Nodes should be empty.");
+
+			Instruction * firstInstr = &(block->front());
+			Nodes->push_back(InstrToIndex[firstInstr]);
+			for (auto ii = block->begin(), ie = block->end(); ii != ie; ++ii) {
+				Instruction * instr = &*ii;
+				if (instr == firstInstr || isa<PHINode>(instr))
+					continue;
+				Nodes->push_back(InstrToIndex[instr]);
+			}
+
+			if (!Direction)
+				std::reverse(Nodes->begin(), Nodes->end());
+			return;
+		}
+
+		/*
+		 * Utility function:
+		 *   Compute until the information on the edges of a component does not change.
+		 *   Only the instructions of the component go into the worklist.
+		 */
+		void solveSCC(const std::vector<unsigned> & Members, const std::vector<unsigned> & SCCOf) {
+			std::deque<unsigned> worklist(Members.begin(), Members.end());
+			// Queued is only touched at the indices of the component, so components can share it
+			for (unsigned index : Members)
+				Queued[index] = 1;
+			unsigned pops = 0, redundant = 0;
+			while (!worklist.empty()) {
+				unsigned index = worklist.front();
+				worklist.pop_front();
+				--Queued[index];
+				++pops;
+
+				std::vector<unsigned> changed;
+				processInstr(index, &changed);
+				for (unsigned dst : changed) {
+					if (SCCOf[dst] == SCCOf[index]) {
+						redundant += Queued[dst]++ > 0;
+						worklist.push_back(dst);
+					}
+				}
+			}
+
+			auto lock = lockShared();
+			Stats.WorklistPops += pops;
+			Stats.RedundantPushes += redundant;
+		}
+
+		/*
+		 * Utility function:
+		 *   The successors of a basic block in analysis order.
+		 */
+		void getAnalysisSuccessors(BasicBlock * block, std::vector<BasicBlock *> * Succs) {
+			if (Direction) {
+				for (auto si = succ_begin(block), se = succ_end(block); si != se; ++si)
+					Succs->push_back(*si);
+			} else {
+				for (auto pi = pred_begin(block), pe = pred_end(block); pi != pe; ++pi)
+					Succs->push_back(*pi);
+			}
+		}
+
+		/*
+		 * A component of the weak topological order: a block, or a head with the components inside its loop.
+		 */
+		struct WTONode {
+			BasicBlock * Block;
+			bool Loop;
+			std::vector<WTONode> Body;
+		};
+
+		/*
+		 * Bourdoncle's algorithm, see computeWTO. Partition holds its components
+		 * in reverse order. Return the smallest depth-first number reachable from v.
+		 */
+		unsigned visitWTO(BasicBlock * v, std::map<BasicBlock *, unsigned> & DFN, unsigned & counter,
+											std::vector<BasicBlock *> & stack, std::vector<WTONode> * Partition) {
+			const unsigned done = ~0u;
+			stack.push_back(v);
+			unsigned head = DFN[v] = ++counter;
+			bool loop = false;
+			std::vector<BasicBlock *> succs;
+			getAnalysisSuccessors(v, &succs);
+			for (BasicBlock *w : succs) {
+				unsigned min = DFN[w] == 0 ? visitWTO(w, DFN, counter, stack, Partition) : DFN[w];
+				if (min <= head) {
+					head = min;
+					loop = true;
+				}
+			}
+			if (head != DFN[v])
+				return head;
+
+			DFN[v] = done;
+			BasicBlock *element = stack.back();
+			stack.pop_back();
+			WTONode node = {v, loop, {}};
+			if (loop) {
+				// v is the head of a component: the blocks above it on the stack are visited again inside it
+				while (element != v) {
+					DFN[element] = 0;
+					element = stack.back();
+					stack.pop_back();
+				}
+				for (BasicBlock *w : succs) {
+					if (DFN[w] == 0)
+						visitWTO(w, DFN, counter, stack, &node.Body);
+				}
+				std::reverse(node.Body.begin(), node.Body.end());
+			}
+			Partition->push_back(std::move(node));
+			return head;
+		}
+
+		/*
+		 * Utility function:
+		 *   Flatten the components into WTO.
+		 */
+		void flattenWTO(const std::vector<WTONode> & Partition) {
+			for (const WTONode & node : Partition) {
+				unsigned at = WTO.size();
+				WTO.push_back({node.Block, 0});
+				if (node.Loop) {
+					std::vector<unsigned> nodes;
+					getBlockNodes(node.Block, &nodes);
+					WideningPoint[nodes[0]] = true;
+					flattenWTO(node.Body);
+					WTO[at].End = WTO.size();
+				}
+			}
+		}
+
+		/*
+		 * Compute the weak topological order of the basic blocks of func in analysis order
+		 * with Bourdoncle's algorithm. Every loop of the CFG is inside a component, and the
+		 * head of a component comes before the blocks of its loop. The blocks that the analysis
+		 * cannot reach from its entry are visited last, so after the reverse they come before
+		 * the others, the last ones of the function first.
+		 * The recursion is as deep as the longest path of blocks.
+		 */
+		void computeWTO(Function * func) {
+			std::map<BasicBlock *, unsigned> DFN;
+			std::vector<BasicBlock *> stack;
+			std::vector<WTONode> partition;
+			unsigned counter = 0;
+			visitWTO(EntryInstr->getParent(), DFN, counter, stack, &partition);
+			for (Function::iterator bi = func->begin(), e = func->end(); bi != e; ++bi) {
+				if (DFN[&*bi] == 0)
+					visitWTO(&*bi, DFN, counter, stack, &partition);
+			}
+			std::reverse(partition.begin(), partition.end());
+
+			WTO.clear();
+			WideningPoint.assign(IndexToInstr.size(), false);
+			flattenWTO(partition);
+		}
+
+		/*
+		 * Update of the edges into the heads of the components: widen, or join if the lattice has a finite height.
+		 */
+		bool updateHeadEdge(std::true_type, unsigned src, unsigned dst, Info * info) {
+			return widenEdge(src, dst, info);
+		}
+
+		bool updateHeadEdge(std::false_type, unsigned src, unsigned dst, Info * info) {
+			return updateEdge(src, dst, info);
+		}
+
+		/*
+		 * Visit the instructions of a basic block in analysis order.
+		 */
+		template <class Widen>
+		void visitWTOBlock(BasicBlock * block, Widen widen) {
+			std::vector<unsigned> nodes, changed;
+			getBlockNodes(block, &nodes);
+			for (unsigned index : nodes) {
+				++Stats.WorklistPops;
+				processInstr(index, &changed, [&](unsigned src, unsigned dst, Info * info) {
+					return WideningPoint[dst] ? updateHeadEdge(widen, src, dst, info) : updateEdge(src, dst, info);
+				});
+			}
+			for (unsigned dst : changed)
+				Dirty[dst] = true;
+		}
+
+		/*
+		 * Bourdoncle's recursive iteration strategy over WTO[begin .. end):
+		 * visit the elements in order, and visit each component again until
+		 * the information into its head does not change.
+		 */
+		template <class Widen>
+		void solveWTO(unsigned begin, unsigned end, Widen widen) {
+			for (unsigned i = begin; i < end; ) {
+				const WTOElement element = WTO[i];
+				if (element.End == 0) {
+					visitWTOBlock(element.Block, widen);
+					++i;
+					continue;
+				}
+
+				std::vector<unsigned> nodes;
+				getBlockNodes(element.Block, &nodes);
+				do {
+					Dirty[nodes[0]] = false;
+					visitWTOBlock(element.Block, widen);
+					solveWTO(i + 1, element.End, widen);
+				} while (Dirty[nodes[0]]);
+				i = element.End;
+			}
+		}
+
+		/*
+		 * WTO variant of steps (2) and (3) of runWorklistAlgorithm.
+		 * With std::true_type, the edges into the heads of the components are widened.
+		 */
+		template <class Widen>
+		void runWTOWorklist(Function * func, Widen widen) {
+			computeWTO(func);
+			Dirty.assign(IndexToInstr.size(), false);
+			solveWTO(0, WTO.size(), widen);
+		}
+
+		/*
+		 * Descending passes over the WTO after widening. Every edge gets the information
+		 * computed from the current one, except the edges into the heads, which are narrowed.
+		 */
+		void runNarrowing(unsigned passes) {
+			for (unsigned pass = 0; pass < passes; ++pass) {
+				for (const WTOElement & element : WTO) {
+					std::vector<unsigned> nodes, changed;
+					getBlockNodes(element.Block, &nodes);
+					for (unsigned index : nodes) {
+						++Stats.WorklistPops;
+						processInstr(index, &changed, [this](unsigned src, unsigned dst, Info * info) {
+							return WideningPoint[dst] ? narrowEdge(src, dst, info) : replaceEdge(src, dst, info);
+						});
+					}
+				}
+			}
+		}
+
+		/*
+		 * SCC variant of steps (2) and (3) of runWorklistAlgorithm.
+		 * Condense the edge graph into its strongly connected components and solve
+		 * each component once all the components before it are solved. Independent
+		 * components are solved in parallel with -cse231-dfa-scc-threads.
+		 */
+		void runSCCWorklist() {
+			std::vector<unsigned> SCCOf;
+			unsigned components = computeSCCs(IndexToInstr.size(), IndexToOutgoing, &SCCOf);
+
+			// Instructions of each component, and the components after it in the condensed graph
+			std::vector<std::vector<unsigned>> members(components), succs(components);
+			for (unsigned index = 0; index < SCCOf.size(); ++index) {
+				members[SCCOf[index]].push_back(index);
+				auto it = IndexToOutgoing.find(index);
+				if (it == IndexToOutgoing.end())
+					continue;
+				for (unsigned dst : it->second) {
+					if (SCCOf[dst] != SCCOf[index])
+						succs[SCCOf[index]].push_back(SCCOf[dst]);
+				}
+			}
+			for (std::vector<unsigned> & next : succs) {
+				std::sort(next.begin(), next.end());
+				next.erase(std::unique(next.begin(), next.end()), next.end());
+			}
+			if (!Direction) {
+				for (std::vector<unsigned> & indices : members)
+					std::reverse(indices.begin(), indices.end());
+			}
+
+			Queued.assign(SCCOf.size(), 0);
+			setConcurrent(DFAOptions::SCCThreads != 1);
+			runTaskGraph(succs, DFAOptions::SCCThreads, [&](unsigned c) {
+				solveSCC(members[c], SCCOf);
+			});
+			setConcurrent(false);
+		}
+
+		/*
+		 * Utility function:
+		 *   Reset the information of the edge src->dst to bottom.
+		 */
+		void dropEdge(unsigned src, unsigned dst) {
+			Info *& edgeInfo = EdgeToInfo[std::make_pair(src, dst)];
+			if (HashConsing) {
+				edgeInfo = CanonicalBottom;
+				return;
+			}
+			if (edgeInfo != &Bottom && edgeInfo != &InitialState)
+				releaseInfo(edgeInfo);
+			edgeInfo = &Bottom;
+		}
+
+		/*
+		 * Utility function:
+		 *   In compact mode, recompute the information on the edges inside a basic block
+		 *   by replaying the flow functions from the edges into it.
+		 *   Only one basic block is expanded at a time.
+		 */
+		void expandBlock(BasicBlock * block) {
+			if (!CompactResults || block == ExpandedBlock)
+				return;
+			if (ExpandedBlock != nullptr)
+				dropBlock(ExpandedBlock);
+
+			std::vector<unsigned> nodes, changed;
+			getBlockNodes(block, &nodes);
+			for (int i = 0; i + 1 < nodes.size(); ++i)
+				processInstr(nodes[i], &changed);
+			ExpandedBlock = block;
+		}
+
+		/*
+		 * Utility function:
+		 *   After runSparseAlgorithm, build the information on the outgoing edges of the
+		 *   instructions of a basic block from the facts entering it, with sparseFacts.
+		 *   Each block is built once, the first time one of its edges is needed.
+		 */
+		void materializeBlock(BasicBlock * block) {
+			auto it = SparseBlocks.find(block);
+			if (it == SparseBlocks.end())
+				return;
+			std::vector<unsigned> facts = std::move(it->second);
+			SparseBlocks.erase(it);
+
+			std::vector<unsigned> nodes;
+			getBlockNodes(block, &nodes);
+			for (unsigned index : nodes) {
+				std::vector<unsigned> outgoing, kill, kept;
+				getOutgoingEdges(index, &outgoing);
+				std::vector<std::vector<unsigned>> gen(outgoing.size());
+				sparseFacts(IndexToInstr[index], outgoing, &gen, &kill);
+				std::sort(kill.begin(), kill.end());
+				std::set_difference(facts.begin(), facts.end(), kill.begin(), kill.end(), std::back_inserter(kept));
+
+				// OUT[i] = (IN - Kill) + Gen[i], and the next index in the block gets OUT[0]
+				for (int i = 0; i < outgoing.size(); ++i) {
+					std::sort(gen[i].begin(), gen[i].end());
+					std::vector<unsigned> out;
+					std::set_union(kept.begin(), kept.end(), gen[i].begin(), gen[i].end(), std::back_inserter(out));
+					out.erase(std::unique(out.begin(), out.end()), out.end());
+					if (!out.empty()) {
+						Info info;
+						sparseInfo(out, &info);
+						replaceEdge(index, outgoing[i], &info);
+					}
+					if (i == 0)
+						facts.swap(out);
+				}
+			}
+		}
+
+		/*
+		 * Utility function:
+		 *   Build the basic blocks whose edges joinEdges(index, incoming) reads, see materializeBlock.
+		 */
+		void materializeEdges(unsigned index, bool incoming) {
+			if (SparseBlocks.empty())
+				return;
+			std::vector<unsigned> sources;
+			if (incoming)
+				getIncomingEdges(index, &sources);
+			else
+				sources.push_back(index);
+			for (unsigned src : sources) {
+				if (src != 0)
+					materializeBlock(IndexToInstr[src]->getParent());
+			}
+		}
+
+		/*
+		 * Utility function:
+		 *   Reset the information on the edges inside a basic block.
+		 */
+		void dropBlock(BasicBlock * block) {
+			std::vector<unsigned> nodes;
+			getBlockNodes(block, &nodes);
+			for (int i = 0; i + 1 < nodes.size(); ++i)
+				dropEdge(nodes[i], nodes[i + 1]);
+		}
+
+		/*
+		 * Utility function:
+		 *   Check that the instructions and the CFG edges of func are still the ones
+		 *   the indices and the edges were built from.
+		 */
+		bool sameStructure(Function * func) {
+			unsigned counter = 1;
+			for (inst_iterator I = inst_begin(func), E = inst_end(func); I != E; ++I, ++counter) {
+				auto it = IndexToInstr.find(counter);
+				if (it == IndexToInstr.end() || it->second != &*I)
+					return false;
+			}
+			if (counter != IndexToInstr.size())
+				return false;
+
+			for (Function::iterator bi = func->begin(), e = func->end(); bi != e; ++bi) {
+				unsigned term = InstrToIndex[(Instruction *)bi->getTerminator()];
+				std::vector<unsigned> heads, edges;
+				for (auto si = succ_begin(&*bi), se = succ_end(&*bi); si != se; ++si)
+					heads.push_back(InstrToIndex[&((*si)->front())]);
+				std::sort(heads.begin(), heads.end());
+				heads.erase(std::unique(heads.begin(), heads.end()), heads.end());
+
+				if (Direction)
+					getOutgoingEdges(term, &edges);
+				else
+					getIncomingEdges(term, &edges);
+				if (heads != edges)
+					return false;
+			}
+			return true;
+		}
+
+		/*
+		 * Utility function:
+		 *   Forget the indices, the edges and their information.
+		 */
+		void resetResults() {
+			if (HashConsing) {
+				for (auto &it : InternTable) {
+					for (Info *canonical : it.second)
+						releaseInfo(canonical);
+				}
+			} else {
+				for (auto &it : EdgeToInfo) {
+					if (it.second != &Bottom && it.second != &InitialState)
+						releaseInfo(it.second);
+				}
+			}
+			IndexToInstr.clear();
+			InstrToIndex.clear();
+			EdgeToInfo.clear();
+			IndexToIncoming.clear();
+			IndexToOutgoing.clear();
+			InternTable.clear();
+			InfoToID.clear();
+			JoinMemo.clear();
+			CanonicalBottom = nullptr;
+			ExpandedBlock = nullptr;
+			SparseBlocks.clear();
+			EntryInstr = nullptr;
+			CacheKey.clear();
+		}
+
+		/*
+		 * Utility function:
+		 *   Get the edges inside the basic blocks of func, see getBlockNodes.
+		 *   The other edges are the ones kept in compact mode and in the persistent cache.
+		 */
+		void getInnerEdges(Function * func, std::set<Edge> * Edges) {
+			for (Function::iterator bi = func->begin(), e = func->end(); bi != e; ++bi) {
+				std::vector<unsigned> nodes;
+				getBlockNodes(&*bi, &nodes);
+				for (int i = 0; i + 1 < nodes.size(); ++i)
+					Edges->insert(std::make_pair(nodes[i], nodes[i + 1]));
+			}
+		}
+
+		/*
+		 * Look up func in the persistent cache. On a hit, set the edges between
+		 * the basic blocks from the cache and replay the flow functions inside
+		 * each block, or leave that to expandBlock in compact mode.
+		 * Return false on a miss; the edges are not touched then.
+		 */
+		bool loadResults(Function * func) {
+			// The results depend on the summaries of the callees in interprocedural mode
+			if (CacheID.empty() || DFAOptions::CacheDir.empty() || Summaries != nullptr)
+				return false;
+			CacheKey = DFACache::key(func, CacheID);
+			std::string content;
+			if (!DFACache::load(CacheKey, &content))
+				return false;
+
+			// One line "src dst info" per edge between the blocks, then "end"
+			std::set<Edge> inner;
+			getInnerEdges(func, &inner);
+			std::vector<std::pair<Edge, Info>> facts;
+			SmallVector<StringRef, 64> lines;
+			StringRef(content).split(lines, '\n', -1, false);
+			if (lines.empty() || lines.back() != "end" || lines.size() - 1 != EdgeToInfo.size() - inner.size())
+				return false;
+			for (int i = 0; i + 1 < lines.size(); ++i) {
+				std::pair<StringRef, StringRef> src = lines[i].split(' ');
+				std::pair<StringRef, StringRef> dst = src.second.split(' ');
+				Edge e;
+				if (src.first.getAsInteger(10, e.first) || dst.first.getAsInteger(10, e.second) ||
+						!EdgeToInfo.count(e) || inner.count(e))
+					return false;
+				facts.push_back(std::make_pair(e, Info()));
+				if (!Info::deserialize(dst.second, &facts.back().second))
+					return false;
+			}
+
+			for (auto &it : facts)
+				updateEdge(it.first.first, it.first.second, &it.second);
+			if (!CompactResults) {
+				for (Function::iterator bi = func->begin(), e = func->end(); bi != e; ++bi) {
+					std::vector<unsigned> nodes, changed;
+					getBlockNodes(&*bi, &nodes);
+					for (int i = 0; i + 1 < nodes.size(); ++i)
+						processInstr(nodes[i], &changed);
+				}
+			}
+			return true;
+		}
+
+		/*
+		 * Store the information on the edges between the basic blocks of func
+		 * in the persistent cache, after a miss in loadResults.
+		 */
+		void storeResults(Function * func) {
+			if (CacheKey.empty())
+				return;
+			std::set<Edge> inner;
+			getInnerEdges(func, &inner);
+			std::string content;
+			raw_string_ostream OS(content);
+			for (auto const &it : EdgeToInfo) {
+				if (inner.count(it.first))
+					continue;
+				OS << it.first.first << " " << it.first.second << " ";
+				Info::serialize(it.second, OS);
+				OS << "\n";
+			}
+			OS << "end\n";
+			DFACache::store(CacheKey, OS.str());
+		}
+
+		/*
+		 * Called at the end of the worklist algorithms.
+		 * Store the results in the persistent cache. In compact mode, drop the
+		 * information inside the basic blocks and free the unused Info objects.
+		 */
+		void finishResults(Function * func) {
+			storeResults(func);
+			if (!CompactResults)
+				return;
+
+			for (Function::iterator bi = func->begin(), e = func->end(); bi != e; ++bi)
+				dropBlock(&*bi);
+			ExpandedBlock = nullptr;
+
+			std::sort(FreeInfos.begin(), FreeInfos.end());
+			InfoPool.erase(std::remove_if(InfoPool.begin(), InfoPool.end(), [this](Info *info) {
+				return std::binary_search(FreeInfos.begin(), FreeInfos.end(), info);
+			}), InfoPool.end());
+			for (Info *info : FreeInfos)
+				delete info;
+			FreeInfos.clear();
+		}
+
+		/*
+		 * Utility function:
+		 *   Join the information on the incoming or the outgoing edges of the instruction identified by index.
+		 */
+		Info joinEdges(unsigned index, bool incoming) {
+			std::vector<unsigned> edges;
+			if (incoming)
+				getIncomingEdges(index, &edges);
+			else
+				getOutgoingEdges(index, &edges);
+
+			Info result;
+			for (unsigned other : edges) {
+				Edge e = incoming ? std::make_pair(other, index) : std::make_pair(index, other);
+				Info::join(&result, EdgeToInfo[e], &result);
+			}
+			return result;
+		}
+
+		/*
+		 * Solve the outgoing edges of the instructions in Seeds on demand.
+		 *   The region is every index that reaches a seed in the edge graph without going through
+		 *   a solved index. It contains the unsolved predecessors of its indices, so the worklist
+		 *   restricted to it reaches the same fixpoint as on the whole function, and its outgoing
+		 *   edges are final afterwards.
+		 */
+		void solveDemand(const std::vector<unsigned> & Seeds) {
+			// (1) Find the region backward from the seeds
+			std::vector<bool> inRegion(IndexToInstr.size(), false);
+			std::vector<unsigned> region;
+			for (unsigned index : Seeds) {
+				if (!Solved[index] && !inRegion[index]) {
+					inRegion[index] = true;
+					region.push_back(index);
+				}
+			}
+			for (int i = 0; i < region.size(); ++i) {
+				std::vector<unsigned> incoming_edges;
+				getIncomingEdges(region[i], &incoming_edges);
+				for (unsigned src : incoming_edges) {
+					if (!Solved[src] && !inRegion[src]) {
+						inRegion[src] = true;
+						region.push_back(src);
+					}
+				}
+			}
+
+			// (2) Initialize the work list with the region in analysis order
+			std::sort(region.begin(), region.end());
+			if (!Direction)
+				std::reverse(region.begin(), region.end());
+			std::deque<unsigned> worklist(region.begin(), region.end());
+			std::vector<unsigned> queued(IndexToInstr.size(), 0);
+			for (unsigned index : region)
+				queued[index] = 1;
+
+			// (3) Compute until the work list is empty; the edges leaving the region are only updated
+			while (!worklist.empty()) {
+				unsigned index = worklist.front();
+				worklist.pop_front();
+				--queued[index];
+				++Stats.WorklistPops;
+
+				std::vector<unsigned> changed;
+				processInstr(index, &changed);
+				for (unsigned dst : changed) {
+					if (!inRegion[dst])
+						continue;
+					Stats.RedundantPushes += queued[dst]++ > 0;
+					worklist.push_back(dst);
+				}
+			}
+
+			for (unsigned index : region)
+				Solved[index] = true;
+			Stats.QuerySolved += region.size();
+		}
+
+		/*
+		 * Steps (2) and (3) of runWorklistAlgorithm, with the solver chosen by the options.
+		 */
+		void solveDense(Function * func) {
+			if (SCCSolving)
+				runSCCWorklist();
+			else if (WTOSolving)
+				runWTOWorklist(func, std::false_type());
+			else
+				runInstrWorklist();
+		}
+
+		/*
+		 * Steps (2) and (3) of runWorklistAlgorithm.
+		 */
+		void runInstrWorklist() {
+			std::deque<unsigned> worklist;
+
+			// (2) Initialize the work list
+			for (auto iter = IndexToInstr.begin(); iter != IndexToInstr.end(); ++iter) {
+				worklist.push_back(iter->first);
+			}
+			std::vector<unsigned> queued(IndexToInstr.size(), 1);
+
+			// (3) Compute until the work list is empty
+			while (!worklist.empty()) {
+				unsigned index = worklist.front();
+				worklist.pop_front();
+				--queued[index];
+				++Stats.WorklistPops;
+
+				// add instructions with changed incoming information to the worklist
+				std::vector<unsigned> changed;
+				processInstr(index, &changed);
+				for (unsigned dst : changed) {
+					Stats.RedundantPushes += queued[dst]++ > 0;
+					worklist.push_back(dst);
+				}
+			}
 		}
+
+    /*
+     * The flow function.
+     *   Instruction I: the IR instruction to be processed.
+     *   std::vector<unsigned> & IncomingEdges: the vector of the indices of the source instructions of the incoming edges.
+     *   std::vector<unsigned> & IncomingEdges: the vector of indices of the source instructions of the outgoing edges.
+     *   std::vector<Info *> & Infos: the vector of the newly computed information for each outgoing eages.
+     *
+     * Direction:
+     * 	 Implement this function in subclasses.
+     */
+    virtual void flowfunction(Instruction * I,
+    													std::vector<unsigned> & IncomingEdges,
+															std::vector<unsigned> & OutgoingEdges,
+															std::vector<Info *> & Infos) = 0;
+
+    /*
+     * The summary function used by runBlockWorklistAlgorithm.
+     *   Instruction I: an instruction in the interior of a basic block (never a phi node or a block boundary).
+     *   Info * Gen, Info * Kill: empty on entry. Describe I as OUT = (IN - Kill) + Gen.
+     *   Return false if I cannot be described this way.
+     *
+     * Direction:
+     *   Optional. The default has no summary, so runBlockWorklistAlgorithm
+     *   falls back to the instruction-level algorithm.
+     */
+    virtual bool summarize(Instruction * I, Info * Gen, Info * Kill) {
+    	return false;
+    }
+
+    /*
+     * The facts used by runSparseAlgorithm, for analyses whose information is a set of facts,
+     * e.g. the indices of SSA values.
+     *   Instruction I: an instruction with outgoing edges to OutgoingEdges.
+     *   Gen: one empty vector per outgoing edge. Kill: empty on entry.
+     *   Describe I as OUT[i] = (IN - Kill) + Gen[i]. Return false if I cannot be described this way.
+     *   It is called again for I when the information on its edges is built, see materializeBlock.
+     * sparseInfo builds the information made of Facts in result, which is bottom on entry.
+     *
+     * Direction:
+     *   Optional. Without them runSparseAlgorithm falls back to runWorklistAlgorithm.
+     */
+    virtual bool sparseFacts(Instruction * I, std::vector<unsigned> & OutgoingEdges,
+    												 std::vector<std::vector<unsigned>> * Gen, std::vector<unsigned> * Kill) {
+    	return false;
+    }
+
+    virtual void sparseInfo(const std::vector<unsigned> & Facts, Info * result) {}
+
+    /*
+     * The function summary used by runInterprocedural.
+     *   Function * F: the function that was just solved.
+     *   Info * Summary: bottom on entry. Condense the result of F for its callers.
+     *
+     * Direction:
+     *   Optional. The default is the join of the information at the end of the
+     *   function in analysis order, i.e. on the incoming edges of the instructions
+     *   without outgoing edges.
+     */
+    virtual void summarizeFunction(Function * F, Info * Summary) {
+    	for (auto const &it : IndexToInstr) {
+    		if (it.first != 0 && !IndexToOutgoing.count(it.first)) {
+    			Info fact = getFactBefore(it.second);
+    			Info::join(Summary, &fact, Summary);
+    		}
+    	}
+    }
+
+    /*
+     * Utility function for flow functions in interprocedural mode:
+     *   The summary of the function called by I, or nullptr if I is not a direct
+     *   call to a function of the module or the analysis is intraprocedural.
+     */
+    const Info * getCalleeSummary(Instruction * I) {
+    	if (Summaries == nullptr)
+    		return nullptr;
+    	auto it = Summaries->find(getCalledFunction(I));
+    	return it == Summaries->end() ? nullptr : &it->second;
+    }
+
+    /*
+     * Static dispatch of flowfunction and summarize.
+     *   Without Derived, the calls go through the virtual functions.
+     *   With Derived, the qualified calls are resolved at compile time.
+     */
+    void callFlowFunction(Instruction * I,
+    											std::vector<unsigned> & IncomingEdges,
+    											std::vector<unsigned> & OutgoingEdges,
+    											std::vector<Info *> & Infos) {
+    	dispatchFlowFunction(std::is_void<Derived>(), I, IncomingEdges, OutgoingEdges, Infos);
+    }
+
+    void dispatchFlowFunction(std::true_type, Instruction * I,
+    													std::vector<unsigned> & IncomingEdges,
+    													std::vector<unsigned> & OutgoingEdges,
+    													std::vector<Info *> & Infos) {
+    	flowfunction(I, IncomingEdges, OutgoingEdges, Infos);
+    }
+
+    void dispatchFlowFunction(std::false_type, Instruction * I,
+    													std::vector<unsigned> & IncomingEdges,
+    													std::vector<unsigned> & OutgoingEdges,
+    													std::vector<Info *> & Infos) {
+    	static_cast<Derived *>(this)->Derived::flowfunction(I, IncomingEdges, OutgoingEdges, Infos);
+    }
+
+    bool callSummarize(Instruction * I, Info * Gen, Info * Kill) {
+    	return dispatchSummarize(std::is_void<Derived>(), I, Gen, Kill);
+    }
+
+    bool dispatchSummarize(std::true_type, Instruction * I, Info * Gen, Info * Kill) {
+    	return summarize(I, Gen, Kill);
+    }
+
+    bool dispatchSummarize(std::false_type, Instruction * I, Info * Gen, Info * Kill) {
+    	return static_cast<Derived *>(this)->Derived::summarize(I, Gen, Kill);
+    }
+
+  public:
+    DataFlowAnalysis(Info & bottom, Info & initialState) :
+    								 Bottom(bottom), InitialState(initialState),EntryInstr(nullptr),
+    								 HashConsing(DFAOptions::HashCons), CanonicalBottom(nullptr),
+    								 CompactResults(DFAOptions::Compact), ExpandedBlock(nullptr),
+    								 SCCSolving(DFAOptions::SCC), Concurrent(false), WTOSolving(DFAOptions::WTO),
+    								 Summaries(nullptr) {}
+
+    virtual ~DataFlowAnalysis() {
+    	for (Info *info : InfoPool)
+    		delete info;
+    }
+
+    /*
+     * Print out the analysis results.
+     *
+     * Direction:
+     * 	 Do not change this funciton.
+     * 	 The autograder will check the output of this function.
+     */
+    void print(raw_ostream & OS = errs()) {
+    	DFATimer timer(&Stats.PrintTime);
+			for (auto const &it : EdgeToInfo) {
+				if (CompactResults && it.first.first != 0)
+					expandBlock(IndexToInstr[it.first.first]->getParent());
+				if (it.first.first != 0)
+					materializeEdges(it.first.first, false);
+				OS << "Edge " << it.first.first << "->" "Edge " << it.first.second << ":";
+				(it.second)->print(OS);
+			}
+    }
+
+    /*
+     * Solve in interprocedural mode with the summaries of the callees.
+     */
+    void setSummaries(const std::map<Function *, Info> * summaries) {
+    	Summaries = summaries;
+    }
+
+    /*
+     * Compute the summary of the solved function F, see summarizeFunction.
+     */
+    void getSummary(Function * F, Info * Summary) {
+    	summarizeFunction(F, Summary);
+    }
+
+    /*
+     * Print out the statistics of the framework.
+     */
+    void printStatistics(raw_ostream & OS = errs()) {
+    	OS << "Info requested: " << Stats.InfoRequests << ", allocated: " << Stats.InfoAllocations << "\n";
+    	if (HashConsing)
+    		OS << "Info interned: " << Stats.InternedInfos << ", memoized joins: " << Stats.MemoizedJoins << "\n";
+    	OS << "Worklist pops: " << Stats.WorklistPops << ", redundant pushes: " << Stats.RedundantPushes << "\n";
+    	OS << "Flow functions: " << Stats.FlowFunctionCalls << ", joins: " << Stats.Joins
+    		 << ", equalities: " << Stats.Equalities << ", changed edges: " << Stats.ChangedEdges << "\n";
+    	if (Stats.Queries > 0)
+    		OS << "Queries: " << Stats.Queries << ", solved instructions: " << Stats.QuerySolved
+    			 << " of " << IndexToInstr.size() << "\n";
+    	OS << "Peak live Info: " << Stats.PeakLiveInfos << " (" << Stats.PeakLiveInfos * sizeof(Info) << " bytes)\n";
+    	OS << format("Time init: %.6f s, solve: %.6f s, print: %.6f s\n", Stats.InitTime, Stats.SolveTime, Stats.PrintTime);
+    }
+
+    const DFAStatistics & getStatistics() const {
+    	return Stats;
+    }
+
+    /*
+     * Report the statistics of func to -cse231-dfa-stats-json and -cse231-dfa-top-slowest.
+     * Call it after print, so that the printing time is included.
+     */
+    void reportStatistics(Function * func) {
+    	DFAReport::record(func, Stats, IndexToInstr.empty() ? 0 : IndexToInstr.size() - 1, sizeof(Info));
+    }
+
+    /*
+     * Query the information at the program point right before instruction I.
+     * It works in compact mode as well, and is the interface for client passes.
+     */
+    Info getFactBefore(Instruction * I) {
+    	return getFact(I, Direction);
+    }
+
+    /*
+     * Query the information at the program point right after instruction I.
+     */
+    Info getFactAfter(Instruction * I) {
+    	return getFact(I, !Direction);
+    }
+
+    /*
+     * Join the information on the incoming (analysis order) edges of I if incoming is true,
+     * otherwise on its outgoing edges. All the phi nodes of a block share the edges of the first one.
+     */
+    Info getFact(Instruction * I, bool incoming) {
+    	if (isa<PHINode>(I))
+    		I = &(I->getParent()->front());
+    	expandBlock(I->getParent());
+    	materializeEdges(InstrToIndex[I], incoming);
+    	return joinEdges(InstrToIndex[I], incoming);
+    }
+
+    /*
+     * Prepare demand-driven queries on func, instead of solving it with runWorklistAlgorithm.
+     * queryFactBefore and queryFactAfter then solve only the instructions their answer
+     * depends on, and the later queries reuse what the earlier ones solved. The answers
+     * are the ones of runWorklistAlgorithm. Compact mode and the persistent cache do not apply.
+     */
+    void initializeQueries(Function * func) {
+    	DFATimer timer(&Stats.InitTime);
+    	if (Direction)
+    		initializeForwardMap(func);
+    	else
+    		initializeBackwardMap(func);
+
+    	assert(EntryInstr != nullptr && "Entry instruction is null.");
+    	if (HashConsing)
+    		internEdges();
+    	CompactResults = false;
+    	Solved.assign(IndexToInstr.size(), false);
+    }
+
+    /*
+     * Demand-driven getFactBefore, after initializeQueries.
+     */
+    Info queryFactBefore(Instruction * I) {
+    	return queryFact(I, Direction);
+    }
+
+    /*
+     * Demand-driven getFactAfter, after initializeQueries.
+     */
+    Info queryFactAfter(Instruction * I) {
+    	return queryFact(I, !Direction);
+    }
+
+    /*
+     * Demand-driven getFact, after initializeQueries.
+     *   The incoming edges of I only depend on the instructions before it in the analysis order,
+     *   its outgoing edges also on I itself.
+     */
+    Info queryFact(Instruction * I, bool incoming) {
+    	assert(Solved.size() == IndexToInstr.size() && "Queries are not initialized.");
+    	if (isa<PHINode>(I))
+    		I = &(I->getParent()->front());
+    	unsigned index = InstrToIndex[I];
+
+    	std::vector<unsigned> seeds;
+    	if (incoming)
+    		getIncomingEdges(index, &seeds);
+    	else
+    		seeds.push_back(index);
+    	{
+    		DFATimer timer(&Stats.SolveTime);
+    		++Stats.Queries;
+    		solveDemand(seeds);
+    	}
+    	return joinEdges(index, incoming);
+    }
+
+    /*
+     * Re-solve after the instructions in Changed were edited in place, e.g. their operands.
+     *   Only the instructions reachable from the changed ones in the edge graph can get
+     *   different information. Their outgoing edges are reset to bottom, since an edit may
+     *   make the information smaller, and only they go into the worklist; the information
+     *   on every other edge is kept.
+     *   If instructions or CFG edges were added or removed, the indices are stale, so
+     *   everything is reset and solved from scratch. The same happens in compact mode,
+     *   where the edges inside the basic blocks are not kept, and after runSparseAlgorithm,
+     *   whose edges are built from the edited instructions.
+     */
+    void updateWorklistAlgorithm(Function * func, const std::vector<Instruction *> & Changed) {
+    	if (EntryInstr == nullptr || CompactResults || !SparseBlocks.empty() || !sameStructure(func)) {
+    		resetResults();
+    		runWorklistAlgorithm(func);
+    		return;
+    	}
+
+    	// (1) Find the affected instructions. All the phi nodes of a block share the edges of the first one.
+    	std::vector<bool> affected(IndexToInstr.size(), false);
+    	std::vector<unsigned> region;
+    	for (Instruction *I : Changed) {
+    		if (isa<PHINode>(I))
+    			I = &(I->getParent()->front());
+    		unsigned index = InstrToIndex[I];
+    		if (!affected[index]) {
+    			affected[index] = true;
+    			region.push_back(index);
+    		}
+    	}
+    	for (int i = 0; i < region.size(); ++i) {
+    		std::vector<unsigned> outgoing_edges;
+    		getOutgoingEdges(region[i], &outgoing_edges);
+    		for (unsigned dst : outgoing_edges) {
+    			if (!affected[dst]) {
+    				affected[dst] = true;
+    				region.push_back(dst);
+    			}
+    		}
+    	}
+
+    	// (2) Reset their outgoing edges and initialize the work list with them
+    	std::sort(region.begin(), region.end());
+    	if (!Direction)
+    		std::reverse(region.begin(), region.end());
+    	for (unsigned index : region) {
+    		std::vector<unsigned> outgoing_edges;
+    		getOutgoingEdges(index, &outgoing_edges);
+    		for (unsigned dst : outgoing_edges)
+    			dropEdge(index, dst);
+    	}
+    	std::deque<unsigned> worklist(region.begin(), region.end());
+    	std::vector<unsigned> queued(IndexToInstr.size(), 0);
+    	for (unsigned index : region)
+    		queued[index] = 1;
+
+    	// (3) Compute until the work list is empty
+    	while (!worklist.empty()) {
+    		unsigned index = worklist.front();
+    		worklist.pop_front();
+    		--queued[index];
+    		++Stats.WorklistPops;
+
+    		std::vector<unsigned> changed;
+    		processInstr(index, &changed);
+    		for (unsigned dst : changed) {
+    			Stats.RedundantPushes += queued[dst]++ > 0;
+    			worklist.push_back(dst);
+    		}
+    	}
+    }
+
+    /*
+     * Re-solve after the instructions of the basic blocks in Changed were edited in place.
+     */
+    void updateWorklistAlgorithm(Function * func, const std::vector<BasicBlock *> & Changed) {
+    	std::vector<Instruction *> instrs;
+    	for (BasicBlock *block : Changed) {
+    		for (auto ii = block->begin(), ie = block->end(); ii != ie; ++ii)
+    			instrs.push_back(&*ii);
+    	}
+    	updateWorklistAlgorithm(func, instrs);
     }
+
+    /*
+     * This function implements the work list algorithm in the following steps:
+     * (1) Initialize info of each edge to bottom
+     * (2) Initialize the worklist
+     * (3) Compute until the worklist is empty
+     *
+     * Direction:
+     *   Implement the rest of the function.
+     *   You may not change anything before "// (2) Initialize the worklist".
+     */
+    void runWorklistAlgorithm(Function * func) {
+    	// (1) Initialize info of each edge to bottom
+    	{
+    		DFATimer timer(&Stats.InitTime);
+    		if (Direction)
+    			initializeForwardMap(func);
+    		else
+    			initializeBackwardMap(func);
+
+    		assert(EntryInstr != nullptr && "Entry instruction is null.");
+    		if (HashConsing)
+    			internEdges();
+    	}
+    	DFATimer timer(&Stats.SolveTime);
+    	if (loadResults(func))
+    		return;
+
+    	// (2) and (3)
+    	solveDense(func);
+    	finishResults(func);
+    }
+
+    /*
+     * Variant of runWorklistAlgorithm for lattices of infinite height, e.g. intervals.
+     * It visits the basic blocks in weak topological order and stabilizes each component
+     * before the blocks after it. The edges into the head of a component are widened with
+     * Info::widen, so that each component stabilizes after a finite number of visits.
+     * Then -cse231-dfa-narrowing descending passes recover precision with Info::narrow.
+     */
+    void runWideningWorklistAlgorithm(Function * func) {
+    	{
+    		DFATimer timer(&Stats.InitTime);
+    		if (Direction)
+    			initializeForwardMap(func);
+    		else
+    			initializeBackwardMap(func);
+
+    		assert(EntryInstr != nullptr && "Entry instruction is null.");
+    		if (HashConsing)
+    			internEdges();
+    	}
+    	DFATimer timer(&Stats.SolveTime);
+    	if (loadResults(func))
+    		return;
+
+    	runWTOWorklist(func, std::true_type());
+    	runNarrowing(DFAOptions::Narrowing);
+    	finishResults(func);
+    }
+
+    /*
+     * Block-level variant of runWorklistAlgorithm. It computes the same result in the following steps:
+     * (1) Initialize info of each edge to bottom
+     * (2) Compose the summaries of the instructions inside each basic block
+     * (3) Compute over the boundaries of the basic blocks until the worklist is empty
+     * (4) Expand the block summaries to the edges inside each basic block
+     *
+     * The worklist only holds basic blocks. A visit runs the flow function on
+     * the first and the last instruction of the block and applies the summary in between.
+     * If some instruction has no summary, it falls back to the instruction-level algorithm.
+     */
+    void runBlockWorklistAlgorithm(Function * func) {
+    	// (1) Initialize info of each edge to bottom
+    	{
+    		DFATimer timer(&Stats.InitTime);
+    		if (Direction)
+    			initializeForwardMap(func);
+    		else
+    			initializeBackwardMap(func);
+
+    		assert(EntryInstr != nullptr && "Entry instruction is null.");
+    		if (HashConsing)
+    			internEdges();
+    	}
+    	DFATimer timer(&Stats.SolveTime);
+    	if (loadResults(func))
+    		return;
+
+    	// The SCC solver works on the instructions
+    	if (SCCSolving) {
+    		runSCCWorklist();
+    		finishResults(func);
+    		return;
+    	}
+
+    	// (2) Compose the summaries: Gen and Kill of Nodes[1 .. n-2], which maps
+    	// the edge Nodes[0]->Nodes[1] to the edge Nodes[n-2]->Nodes[n-1]
+    	struct BlockSummary {
+    		std::vector<unsigned> Nodes;
+    		Info Gen;
+    		Info Kill;
+    	};
+    	std::vector<BlockSummary> summaries(func->size());
+    	std::map<unsigned, unsigned> HeadToBlock;
+    	unsigned count = 0;
+    	for (Function::iterator bi = func->begin(), e = func->end(); bi != e; ++bi, ++count) {
+    		BlockSummary & summary = summaries[count];
+    		getBlockNodes(&*bi, &summary.Nodes);
+    		HeadToBlock[summary.Nodes.front()] = count;
+
+    		for (int i = 1; i + 1 < summary.Nodes.size(); ++i) {
+    			Info gen, kill;
+    			if (!callSummarize(IndexToInstr[summary.Nodes[i]], &gen, &kill)) {
+    				runInstrWorklist();
+    				finishResults(func);
+    				return;
+    			}
+    			Info::transfer(&summary.Gen, &gen, &kill, &summary.Gen);
+    			Info::join(&summary.Kill, &kill, &summary.Kill);
+    		}
+    	}
+
+    	// (3) Compute until the work list is empty
+    	std::deque<unsigned> worklist;
+    	std::vector<bool> inWorklist(summaries.size(), true);
+    	for (unsigned b = 0; b < summaries.size(); ++b)
+    		worklist.push_back(Direction ? b : summaries.size() - 1 - b);
+
+    	while (!worklist.empty()) {
+    		unsigned b = worklist.front();
+    		worklist.pop_front();
+    		inWorklist[b] = false;
+    		++Stats.WorklistPops;
+
+    		std::vector<unsigned> & nodes = summaries[b].Nodes;
+    		unsigned n = nodes.size();
+    		std::vector<unsigned> changed;
+    		processInstr(nodes[0], &changed);
+    		if (n >= 3) {
+    			Info out;
+    			Info::transfer(EdgeToInfo[std::make_pair(nodes[0], nodes[1])],
+    										 &summaries[b].Gen, &summaries[b].Kill, &out);
+    			updateEdge(nodes[n - 2], nodes[n - 1], &out);
+    		}
+    		if (n >= 2)
+    			processInstr(nodes[n - 1], &changed);
+
+    		// add blocks with changed incoming information to the worklist
+    		for (unsigned dst : changed) {
+    			auto it = HeadToBlock.find(dst);
+    			if (it != HeadToBlock.end() && !inWorklist[it->second]) {
+    				inWorklist[it->second] = true;
+    				worklist.push_back(it->second);
+    			}
+    		}
+    	}
+
+    	// (4) Expand the summaries, one pass in analysis order per block.
+    	// Compact mode would drop them again, so they are recomputed on demand instead.
+    	if (!CompactResults) {
+    		for (BlockSummary & summary : summaries) {
+    			std::vector<unsigned> changed;
+    			for (int i = 1; i + 1 < summary.Nodes.size(); ++i)
+    				processInstr(summary.Nodes[i], &changed);
+    		}
+    	}
+    	finishResults(func);
+    }
+
+    /*
+     * Sparse variant of runWorklistAlgorithm for set-of-facts analyses, see sparseFacts.
+     *   Each fact is solved on its own at the level of the basic blocks: from the edges that
+     *   generate it, e.g. the uses of a value in liveness or its definition in reaching
+     *   definitions, it goes to the next blocks in analysis order until a block that kills it,
+     *   e.g. the one of the definition in liveness. Only the blocks a fact enters are visited,
+     *   so a value costs the blocks of its live range in liveness, and the blocks reachable
+     *   from its definition in reaching definitions, instead of instructions x iterations.
+     *   The result is the facts that enter each block. The information of the edges is built
+     *   from them only when print or getFact needs it, see materializeBlock.
+     *   The information of the instructions that are not described by sparseFacts, e.g. memory
+     *   state, and a non-bottom initial state, need the dense algorithm, which is used instead.
+     */
+    void runSparseAlgorithm(Function * func) {
+    	// (1) Initialize info of each edge to bottom
+    	{
+    		DFATimer timer(&Stats.InitTime);
+    		if (Direction)
+    			initializeForwardMap(func);
+    		else
+    			initializeBackwardMap(func);
+
+    		assert(EntryInstr != nullptr && "Entry instruction is null.");
+    		if (HashConsing)
+    			internEdges();
+    	}
+    	DFATimer timer(&Stats.SolveTime);
+    	if (loadResults(func))
+    		return;
+    	if (!Info::equal(&InitialState, &Bottom)) {
+    		solveDense(func);
+    		finishResults(func);
+    		return;
+    	}
+
+    	// (2) Number the blocks, and collect the facts that each instruction generates and kills.
+    	// The position of an index is its place in the nodes of its block, see getBlockNodes.
+    	std::vector<BasicBlock *> blocks;
+    	std::vector<std::vector<unsigned>> blockNodes, successors;
+    	std::vector<unsigned> blockOf(IndexToInstr.size()), positionOf(IndexToInstr.size());
+    	std::vector<std::vector<unsigned>> killedBy(IndexToInstr.size());
+    	std::vector<std::tuple<unsigned, unsigned, bool>> seeds;
+    	for (Function::iterator bi = func->begin(), e = func->end(); bi != e; ++bi) {
+    		std::vector<unsigned> nodes;
+    		getBlockNodes(&*bi, &nodes);
+    		for (unsigned i = 0; i < nodes.size(); ++i) {
+    			blockOf[nodes[i]] = blocks.size();
+    			positionOf[nodes[i]] = i;
+    		}
+    		blocks.push_back(&*bi);
+    		blockNodes.push_back(nodes);
+    	}
+    	successors.resize(blocks.size());
+    	for (unsigned b = 0; b < blocks.size(); ++b) {
+    		std::vector<unsigned> & nodes = blockNodes[b];
+    		for (unsigned index : nodes) {
+    			std::vector<unsigned> outgoing, kill;
+    			getOutgoingEdges(index, &outgoing);
+    			std::vector<std::vector<unsigned>> gen(outgoing.size());
+    			if (!sparseFacts(IndexToInstr[index], outgoing, &gen, &kill)) {
+    				solveDense(func);
+    				finishResults(func);
+    				return;
+    			}
+    			for (unsigned fact : kill)
+    				killedBy[fact].push_back(index);
+    			// A fact generated on the edge inside the block holds after the index,
+    			// one generated on an edge out of the block enters the block of its head
+    			for (int i = 0; i < outgoing.size(); ++i) {
+    				bool enters = index == nodes.back();
+    				for (unsigned fact : gen[i])
+    					seeds.push_back(std::make_tuple(fact, enters ? outgoing[i] : index, enters));
+    			}
+    			if (index == nodes.back()) {
+    				for (unsigned dst : outgoing)
+    					successors[b].push_back(blockOf[dst]);
+    			}
+    		}
+    	}
+    	std::sort(seeds.begin(), seeds.end());
+    	seeds.erase(std::unique(seeds.begin(), seeds.end()), seeds.end());
+
+    	// (3) Solve the facts one at a time, block by block.
+    	// A fact holds to the end of block b after position unless an index after it kills the fact.
+    	auto killedAfter = [&](unsigned fact, unsigned b, int position) {
+    		for (unsigned index : killedBy[fact]) {
+    			if (blockOf[index] == b && (int)positionOf[index] > position)
+    				return true;
+    		}
+    		return false;
+    	};
+    	std::vector<std::vector<unsigned>> entering(blocks.size());
+    	std::vector<unsigned> entered(blocks.size(), 0);
+    	std::vector<unsigned> worklist;
+    	for (int i = 0; i < seeds.size(); ++i) {
+    		unsigned fact, index;
+    		bool enters;
+    		std::tie(fact, index, enters) = seeds[i];
+    		unsigned b = blockOf[index];
+    		if (enters)
+    			worklist.push_back(b);
+    		else if (!killedAfter(fact, b, positionOf[index]))
+    			worklist.insert(worklist.end(), successors[b].begin(), successors[b].end());
+    		if (i + 1 < seeds.size() && std::get<0>(seeds[i + 1]) == fact)
+    			continue;
+
+    		// The blocks entered by a fact are marked with fact + 1, so the marks need no reset
+    		while (!worklist.empty()) {
+    			b = worklist.back();
+    			worklist.pop_back();
+    			if (entered[b] == fact + 1)
+    				continue;
+    			entered[b] = fact + 1;
+    			entering[b].push_back(fact);
+    			++Stats.WorklistPops;
+    			if (!killedAfter(fact, b, -1))
+    				worklist.insert(worklist.end(), successors[b].begin(), successors[b].end());
+    		}
+    	}
+
+    	// (4) Keep the facts entering each block, in increasing order. The persistent
+    	// cache stores the edges between the blocks, so they are built for it right away.
+    	CompactResults = false;
+    	for (unsigned b = 0; b < blocks.size(); ++b)
+    		SparseBlocks[blocks[b]] = std::move(entering[b]);
+    	if (!CacheKey.empty()) {
+    		for (BasicBlock *block : blocks)
+    			materializeBlock(block);
+    	}
+    	finishResults(func);
+    }
+};
+
+/*
+ * Information of ProductAnalysis: the information of each component.
+ */
+template <class InfoA, class InfoB>
+class ProductInfo : public Info {
+  public:
+	ProductInfo() {}
+
+	void print(raw_ostream & OS = errs()) {
+		First.print(OS);
+		Second.print(OS);
+	}
+
+	static bool equal(ProductInfo * info1, ProductInfo * info2) {
+		return InfoA::equal(&info1->First, &info2->First) && InfoB::equal(&info1->Second, &info2->Second);
+	}
+
+	static ProductInfo * join(ProductInfo * info1, ProductInfo * info2, ProductInfo * result) {
+		if (result == nullptr)
+			result = new ProductInfo();
+		InfoA::join(&info1->First, &info2->First, &result->First);
+		InfoB::join(&info1->Second, &info2->Second, &result->Second);
+		return result;
+	}
+
+	static size_t hash(ProductInfo * info) {
+		return hash_combine(InfoA::hash(&info->First), InfoB::hash(&info->Second));
+	}
+
+	// The first component is prefixed with its length, so the components may use any character
+	static void serialize(ProductInfo * info, raw_ostream & OS) {
+		std::string first;
+		raw_string_ostream buffer(first);
+		InfoA::serialize(&info->First, buffer);
+		buffer.flush();
+		OS << first.size() << ":" << first;
+		InfoB::serialize(&info->Second, OS);
+	}
+
+	static bool deserialize(StringRef text, ProductInfo * result) {
+		size_t colon = text.find(':');
+		unsigned length;
+		if (colon == StringRef::npos || text.substr(0, colon).getAsInteger(10, length) ||
+				colon + 1 + length > text.size())
+			return false;
+		return InfoA::deserialize(text.substr(colon + 1, length), &result->First) &&
+			InfoB::deserialize(text.substr(colon + 1 + length), &result->Second);
+	}
+
+	static void widen(ProductInfo * old, ProductInfo * next, ProductInfo * result) {
+		InfoA::widen(&old->First, &next->First, &result->First);
+		InfoB::widen(&old->Second, &next->Second, &result->Second);
+	}
+
+	static void narrow(ProductInfo * old, ProductInfo * next, ProductInfo * result) {
+		InfoA::narrow(&old->First, &next->First, &result->First);
+		InfoB::narrow(&old->Second, &next->Second, &result->Second);
+	}
+
+	InfoA First;
+	InfoB Second;
+};
+
+/*
+ * Solve two analyses of the same direction in one traversal, over the product of their lattices.
+ *   AnalysisA, AnalysisB: subclasses of DataFlowAnalysis, constructed with (bottom, initialState).
+ *
+ * The edge graph is built once, by the product. The components only lend their flow functions:
+ * they use the indices of the product through useIndices, without a copy, and read their part
+ * of the edges of the product through their EdgeView, so they have no edges of their own.
+ * Nests of products combine more than two analyses.
+ *
+ * In runWorklistAlgorithm, each component tracks its own convergence: its flow function
+ * only runs again at an instruction when its part of an incoming edge changed.
+ * ProductInfo has no transfer, so the product cannot run runBlockWorklistAlgorithm.
+ * print writes the results of the first component, then of the second one, in the format
+ * of DataFlowAnalysis::print.
+ */
+template <class AnalysisA, class AnalysisB>
+class ProductAnalysis : public DataFlowAnalysis<
+		ProductInfo<typename AnalysisA::InfoType, typename AnalysisB::InfoType>,
+		AnalysisA::AnalysisDirection, ProductAnalysis<AnalysisA, AnalysisB>> {
+	static_assert(AnalysisA::AnalysisDirection == AnalysisB::AnalysisDirection,
+								"The components of a product have the same direction.");
+
+	typedef typename AnalysisA::InfoType InfoA;
+	typedef typename AnalysisB::InfoType InfoB;
+	typedef ProductInfo<InfoA, InfoB> Info;
+	typedef DataFlowAnalysis<Info, AnalysisA::AnalysisDirection, ProductAnalysis> Base;
+	typedef typename Base::Edge Edge;
+	friend Base;
+	// A product calls the hooks of the products nested in it
+	template <class A, class B>
+	friend class ProductAnalysis;
+
+	AnalysisA First;
+	AnalysisB Second;
+	// Whether the flow function of each component has to run again at each index
+	std::vector<char> FirstDirty, SecondDirty;
+	// Skip the components whose incoming edges did not change
+	bool Tracking;
+
+	/*
+	 * Run the flow function of Component at I if it is dirty, on its part of the edges,
+	 * which it reads through its EdgeView. Mark the destinations whose part changed as dirty.
+	 */
+	template <class Component, class ComponentInfo, class Part>
+	void componentFlow(Component & component, std::vector<char> & dirty, Part part, unsigned index,
+										 Instruction * I, std::vector<unsigned> & IncomingEdges,
+										 std::vector<unsigned> & OutgoingEdges, std::vector<Info *> & Infos) {
+		if (Tracking) {
+			if (!dirty[index])
+				return;
+			dirty[index] = 0;
+		}
+
+		std::vector<ComponentInfo *> infos(Infos.size());
+		for (int i = 0; i < infos.size(); ++i)
+			infos[i] = &(Infos[i]->*part);
+		component.callFlowFunction(I, IncomingEdges, OutgoingEdges, infos);
+
+		// The flow functions are monotone, so an output changes its edge iff it differs from it
+		if (Tracking) {
+			for (int i = 0; i < infos.size(); ++i) {
+				Info *old = this->edgeInfo(index, OutgoingEdges[i]);
+				if (!ComponentInfo::equal(infos[i], &(old->*part)))
+					dirty[OutgoingEdges[i]] = 1;
+			}
+		}
+	}
+
+	/*
+	 * The components share the edges of the product, so this needs no lock: with the SCC
+	 * solver, the flow functions of the components run in parallel like the ones of any
+	 * other analysis, and their Info pools lock while Concurrent is set, see setConcurrent.
+	 * Tracking is off with the SCC solver, so the dirty flags are not shared between threads.
+	 */
+	virtual void flowfunction(Instruction * I, std::vector<unsigned> & IncomingEdges,
+														std::vector<unsigned> & OutgoingEdges, std::vector<Info *> & Infos) {
+		if (I == nullptr)
+			return;
+		if (Tracking && FirstDirty.size() != this->IndexToInstr.size()) {
+			FirstDirty.assign(this->IndexToInstr.size(), 1);
+			SecondDirty.assign(this->IndexToInstr.size(), 1);
+		}
+		unsigned index = this->InstrToIndex.find(I)->second;
+		componentFlow<AnalysisA, InfoA>(First, FirstDirty, &Info::First, index, I, IncomingEdges, OutgoingEdges, Infos);
+		componentFlow<AnalysisB, InfoB>(Second, SecondDirty, &Info::Second, index, I, IncomingEdges, OutgoingEdges, Infos);
+	}
+
+	virtual void setConcurrent(bool concurrent) {
+		Base::setConcurrent(concurrent);
+		First.setConcurrent(concurrent);
+		Second.setConcurrent(concurrent);
+	}
+
+	// A nested product passes the indices on to its own components
+	virtual void useIndices(const SharedMap<unsigned, Instruction *> & indexToInstr,
+													const SharedMap<Instruction *, unsigned> & instrToIndex) {
+		Base::useIndices(indexToInstr, instrToIndex);
+		First.useIndices(indexToInstr, instrToIndex);
+		Second.useIndices(indexToInstr, instrToIndex);
+	}
+
+  public:
+	ProductAnalysis(Info & bottom, Info & initialState) :
+		Base(bottom, initialState), First(bottom.First, initialState.First),
+		Second(bottom.Second, initialState.Second), Tracking(false) {
+		if (!First.CacheID.empty() && !Second.CacheID.empty())
+			this->CacheID = First.CacheID + " + " + Second.CacheID;
+		First.useIndices(this->IndexToInstr, this->InstrToIndex);
+		Second.useIndices(this->IndexToInstr, this->InstrToIndex);
+		First.EdgeView = [this](unsigned src, unsigned dst) {
+			return &(this->edgeInfo(src, dst)->First);
+		};
+		Second.EdgeView = [this](unsigned src, unsigned dst) {
+			return &(this->edgeInfo(src, dst)->Second);
+		};
+	}
+
+	/*
+	 * DataFlowAnalysis::runWorklistAlgorithm, with the convergence of each component tracked,
+	 * except with the SCC solver.
+	 */
+	void runWorklistAlgorithm(Function * func) {
+		FirstDirty.clear();
+		SecondDirty.clear();
+		Tracking = !this->SCCSolving;
+		Base::runWorklistAlgorithm(func);
+		Tracking = false;
+	}
+
+	void print(raw_ostream & OS = errs()) {
+		DFATimer timer(&this->Stats.PrintTime);
+		for (int k = 0; k < 2; ++k) {
+			for (auto const &it : this->EdgeToInfo) {
+				if (this->CompactResults && it.first.first != 0)
+					this->expandBlock(this->IndexToInstr[it.first.first]->getParent());
+				OS << "Edge " << it.first.first << "->" "Edge " << it.first.second << ":";
+				if (k == 0)
+					it.second->First.print(OS);
+				else
+					it.second->Second.print(OS);
+			}
+		}
+	}
 };
 
+/*
+ * Module-level driver: run a dataflow analysis over all the functions of a module in parallel.
+ *   Analysis: a subclass of DataFlowAnalysis, constructed with (bottom, initialState).
+ *   run: the algorithm to use, e.g. &Analysis::runWorklistAlgorithm.
+ *
+ * The IR is only read while solving, and every function has its own analysis object,
+ * which holds all the scratch state. The output of each function is buffered and
+ * written to OS in the order of the functions in the module, the same as a FunctionPass.
+ */
+template <class Analysis, class Info>
+void runOnModuleParallel(Module & M, Info & bottom, Info & initialState,
+												 void (Analysis::*run)(Function *), raw_ostream & OS = errs()) {
+	std::vector<Function *> functions;
+	for (Function & F : M) {
+		if (!F.isDeclaration())
+			functions.push_back(&F);
+	}
+
+	std::vector<std::string> outputs(functions.size());
+	parallelFor(functions.size(), DFAOptions::Threads, [&](unsigned i) {
+		raw_string_ostream buffer(outputs[i]);
+		Analysis analysis(bottom, initialState);
+		(analysis.*run)(functions[i]);
+		analysis.print(buffer);
+		if (DFAOptions::PrintStats)
+			analysis.printStatistics(buffer);
+		analysis.reportStatistics(functions[i]);
+		buffer.flush();
+	});
+
+	for (const std::string & output : outputs)
+		OS << output;
+	DFAReport::printSlowest(OS);
+}
 
+/*
+ * Interprocedural driver: run a dataflow analysis over the functions of a module bottom-up on the call graph.
+ *   Analysis, run: as in runOnModuleParallel.
+ *
+ * The strongly connected components of the call graph, with the direct calls between the
+ * functions of the module, are solved callees first. Once a function is solved, summarizeFunction
+ * condenses its result, and the flow functions of its callers apply it with getCalleeSummary.
+ * The functions of a recursive component start from bottom summaries and are solved again
+ * until their summaries stop changing. Independent components are solved in parallel with
+ * -cse231-dfa-threads. The output is the same as runOnModuleParallel.
+ */
+template <class Analysis, class Info>
+void runInterprocedural(Module & M, Info & bottom, Info & initialState,
+												void (Analysis::*run)(Function *), raw_ostream & OS = errs()) {
+	std::vector<Function *> functions;
+	std::map<Function *, unsigned> FunctionToIndex;
+	for (Function & F : M) {
+		if (!F.isDeclaration()) {
+			FunctionToIndex[&F] = functions.size();
+			functions.push_back(&F);
+		}
+	}
+
+	// Call graph, from the callers to the callees
+	std::map<unsigned, std::vector<unsigned>> Callees;
+	for (unsigned i = 0; i < functions.size(); ++i) {
+		std::vector<unsigned> & callees = Callees[i];
+		for (inst_iterator I = inst_begin(functions[i]), E = inst_end(functions[i]); I != E; ++I) {
+			auto it = FunctionToIndex.find(getCalledFunction(&*I));
+			if (it != FunctionToIndex.end())
+				callees.push_back(it->second);
+		}
+		std::sort(callees.begin(), callees.end());
+		callees.erase(std::unique(callees.begin(), callees.end()), callees.end());
+	}
+
+	// Number the components callees first, so that every component comes before its callers
+	std::vector<unsigned> SCCOf;
+	unsigned components = computeSCCs(functions.size(), Callees, &SCCOf);
+	std::vector<std::vector<unsigned>> members(components), callers(components);
+	std::vector<bool> recursive(components, false);
+	for (unsigned i = 0; i < functions.size(); ++i) {
+		SCCOf[i] = components - 1 - SCCOf[i];
+		members[SCCOf[i]].push_back(i);
+	}
+	for (unsigned i = 0; i < functions.size(); ++i) {
+		for (unsigned callee : Callees[i]) {
+			if (SCCOf[callee] != SCCOf[i])
+				callers[SCCOf[callee]].push_back(SCCOf[i]);
+			else
+				recursive[SCCOf[i]] = true;
+		}
+	}
+	for (std::vector<unsigned> & next : callers) {
+		std::sort(next.begin(), next.end());
+		next.erase(std::unique(next.begin(), next.end()), next.end());
+	}
+
+	// All the summaries exist up front, so the map is only read while the components are solved
+	std::map<Function *, Info> Summaries;
+	for (Function *F : functions)
+		Summaries.insert(std::make_pair(F, bottom));
+
+	std::vector<std::string> outputs(functions.size());
+	runTaskGraph(callers, DFAOptions::Threads, [&](unsigned c) {
+		bool changed;
+		do {
+			changed = false;
+			for (unsigned i : members[c]) {
+				Analysis analysis(bottom, initialState);
+				analysis.setSummaries(&Summaries);
+				(analysis.*run)(functions[i]);
+
+				Info summary(bottom);
+				analysis.getSummary(functions[i], &summary);
+				Info & current = Summaries.find(functions[i])->second;
+				if (!Info::equal(&summary, &current)) {
+					current = summary;
+					changed = true;
+				}
+
+				outputs[i].clear();
+				raw_string_ostream buffer(outputs[i]);
+				analysis.print(buffer);
+				if (DFAOptions::PrintStats)
+					analysis.printStatistics(buffer);
+				analysis.reportStatistics(functions[i]);
+				buffer.flush();
+			}
+		} while (changed && recursive[c]);
+	});
+
+	for (const std::string & output : outputs)
+		OS << output;
+	DFAReport::printSlowest(OS);
+}
 
 }
 #endif // End LLVM_231DFA_H
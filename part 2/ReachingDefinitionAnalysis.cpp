@@ -1,6 +1,7 @@
 #include "llvm/Pass.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Instruction.h"
+#include "llvm/IR/Module.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <cassert>
@@ -8,6 +9,7 @@
 #include <string>
 
 #include "231DFA.h"
+#include "231DFABench.h"
 
 using namespace llvm;
 using namespace std;
@@ -22,11 +24,11 @@ namespace {
 			ReachingInfo() {}
 			
 			// print the content of defs
-			void print() {
-				// errs() << this << ": ";
+			void print(raw_ostream &OS = errs()) {
+				// OS << this << ": ";
 				for (auto def : defs)
-					errs() << def << "|";
-				errs() << "\n";
+					OS << def << "|";
+				OS << "\n";
 			}
 			
 			// compare the defs of two ReachingInfo
@@ -47,6 +49,39 @@ namespace {
 				return result;
 			}
 
+			// hash of the defs, for hash consing
+			static size_t hash(ReachingInfo *info) {
+				return hash_combine_range(info->defs.begin(), info->defs.end());
+			}
+
+			// defs of result = (defs of in - defs of kill) + defs of gen
+			static void transfer(ReachingInfo *in, ReachingInfo *gen, ReachingInfo *kill, ReachingInfo *result) {
+				if (result != in)
+					result->defs = in->defs;
+				for (unsigned def : kill->defs)
+					result->defs.erase(def);
+				result->defs.insert(gen->defs.begin(), gen->defs.end());
+			}
+
+			// write the defs as in print, for the persistent cache
+			static void serialize(ReachingInfo *info, raw_ostream &OS) {
+				for (unsigned def : info->defs)
+					OS << def << "|";
+			}
+
+			// read back the defs written by serialize
+			static bool deserialize(StringRef text, ReachingInfo *result) {
+				SmallVector<StringRef, 16> items;
+				text.split(items, '|', -1, false);
+				for (StringRef item : items) {
+					unsigned def;
+					if (item.getAsInteger(10, def))
+						return false;
+					result->defs.insert(def);
+				}
+				return true;
+			}
+
 			set<unsigned> defs;
 	};
 
@@ -54,68 +89,105 @@ namespace {
 	 * derived class of 231DFA.h/DataFlowAnalysis
 	 */
 	template<class Info, bool Direction>
-	class ReachingDefinitionAnalysis : public DataFlowAnalysis<Info, Direction> {
+	class ReachingDefinitionAnalysis : public DataFlowAnalysis<Info, Direction, ReachingDefinitionAnalysis<Info, Direction>> {
+		// the framework calls flowfunction and summarize statically
+		friend class DataFlowAnalysis<Info, Direction, ReachingDefinitionAnalysis>;
+
 		public:
 			ReachingDefinitionAnalysis(Info &bottom, Info &initialState):
-				DataFlowAnalysis<Info, Direction>::DataFlowAnalysis(bottom, initialState) {}
+				DataFlowAnalysis<Info, Direction, ReachingDefinitionAnalysis>::DataFlowAnalysis(bottom, initialState) {
+				this->CacheID = "cse231-reaching 1";
+			}
 			
 			~ReachingDefinitionAnalysis() {
 				this->EdgeToInfo.clear();
 			}
 
 		private:
+			// whether the instruction defines a variable, except phi instructions
+			static bool isDefinition(unsigned opcode) {
+				switch (opcode) {
+					// case 1: binary operator
+					case Instruction::Add: case Instruction::FAdd: case Instruction::Sub: case Instruction::FSub:
+					case Instruction::Mul: case Instruction::FMul: case Instruction::UDiv: case Instruction::SDiv:
+					case Instruction::FDiv: case Instruction::URem: case Instruction::SRem: case Instruction::FRem:
+					// case 2: binary bitwise operator
+					case Instruction::Shl: case Instruction::LShr: case Instruction::AShr:
+					case Instruction::And: case Instruction::Or: case Instruction::Xor:
+					// case 3: compare
+					case Instruction::ICmp: case Instruction::FCmp:
+					// case 4: other instructions with result
+					case Instruction::Alloca: case Instruction::Load: case Instruction::GetElementPtr: case Instruction::Select:
+						return true;
+					default:
+						return false;
+				}
+			}
+
 			virtual void flowfunction(Instruction *I, vector<unsigned> &IncomingEdges, vector<unsigned> &OutgoingEdges, vector<Info *> &Infos) {
 				if (I == nullptr)
 					return;
 				unsigned index = this->InstrToIndex[I];
-				string op = I->getOpcodeName();
+				unsigned opcode = I->getOpcode();
 				
-				Info *temp = new Info();
+				Info *temp = this->acquireInfo();
 				for (unsigned src : IncomingEdges) {
-					pair<unsigned, unsigned> e = make_pair(src, index);
-					temp = Info::join(this->EdgeToInfo[e], temp, temp);
-				}
-
-				// case 1: binary operator
-				if (op == "add" || op == "fadd" || op == "sub" || op == "fsub" || op == "mul" || op == "fmul" ||
-					op == "udiv" || op == "sdiv" || op == "fdiv" || op == "urem" || op == "srem" || op == "frem") {
-					temp->defs.insert(index);
-				}
-
-				// case 2: binary bitwise operator
-				if (op == "shl" || op == "lshr" || op == "ashr" || op == "and" || op == "or" || op == "xor") {
-					temp->defs.insert(index);
+					temp = Info::join(this->edgeInfo(src, index), temp, temp);
 				}
 
-				// case 3: compare
-				if (op == "icmp" || op == "fcmp") {
-					temp->defs.insert(index);
-				}
-				
-				// case 4: other instructions with result
-				if (op == "alloca" || op == "load" || op == "getelementptr" || op == "select") {
+				// case 1 - 4: instructions with result
+				if (isDefinition(opcode)) {
 					temp->defs.insert(index);
 				}
 
 				// case 5: phi instruction
-				if (op == "phi") {
+				if (opcode == Instruction::PHI) {
 					while (true) {
 						temp->defs.insert(index);
 						++index;
 						if (this->IndexToInstr.find(index) == this->IndexToInstr.end())
 							break;
 						Instruction *J = this->IndexToInstr[index];
-						if (string(J->getOpcodeName()) != "phi")
+						if (!isa<PHINode>(J))
 							break;
 					}
 				}
 
-				// case 6: instruction without result
-				if (op == "br" || op == "switch" || op == "store");
+				// case 6: instruction without result, nothing to do
 
 				for (int i = 0; i < Infos.size(); ++i)
 					Infos[i]->defs = temp->defs;
-				delete temp;
+				this->releaseInfo(temp);
+			}
+
+			// summary for the block-level engine: OUT = IN + {index} for a definition
+			virtual bool summarize(Instruction *I, Info *Gen, Info *Kill) {
+				unsigned opcode = I->getOpcode();
+				if (opcode == Instruction::PHI)
+					return false;
+				if (isDefinition(opcode))
+					Gen->defs.insert(this->InstrToIndex[I]);
+				return true;
+			}
+
+			// facts for the sparse engine: OUT = IN + the definitions of I, as flowfunction
+			virtual bool sparseFacts(Instruction *I, vector<unsigned> &OutgoingEdges, vector<vector<unsigned>> *Gen, vector<unsigned> *Kill) {
+				unsigned index = this->InstrToIndex[I];
+				vector<unsigned> defs;
+				if (isDefinition(I->getOpcode()))
+					defs.push_back(index);
+				// a phi instruction defines all the phi of the block
+				if (isa<PHINode>(I)) {
+					for (; this->IndexToInstr.find(index) != this->IndexToInstr.end() && isa<PHINode>(this->IndexToInstr[index]); ++index)
+						defs.push_back(index);
+				}
+				for (vector<unsigned> &gen : *Gen)
+					gen = defs;
+				return true;
+			}
+
+			virtual void sparseInfo(const vector<unsigned> &Facts, Info *result) {
+				result->defs.insert(Facts.begin(), Facts.end());
 			}
 	};
 	
@@ -130,8 +202,73 @@ namespace {
 		bool runOnFunction(Function &F) override {
 			ReachingInfo bottom;			
 			ReachingDefinitionAnalysis<ReachingInfo, true> rda(bottom, bottom);
-			rda.runWorklistAlgorithm(&F);
+			if (DFAOptions::Sparse)
+				rda.runSparseAlgorithm(&F);
+			else
+				rda.runBlockWorklistAlgorithm(&F);
 			rda.print();
+			if (DFAOptions::PrintStats)
+				rda.printStatistics();
+			rda.reportStatistics(&F);
+			return false;
+		}
+
+		bool doFinalization(Module &M) override {
+			DFAReport::printSlowest();
+			return false;
+		}
+
+	};
+
+	/*
+	 * a module pass do the reaching defintion analysis on all the functions in parallel
+	 */
+	struct ReachingDefinitionAnalysisModulePass : public ModulePass {
+		static char ID;
+
+		ReachingDefinitionAnalysisModulePass() : ModulePass(ID) {}
+
+		bool runOnModule(Module &M) override {
+			ReachingInfo bottom;
+			runOnModuleParallel<ReachingDefinitionAnalysis<ReachingInfo, true>>(M, bottom, bottom,
+				DFAOptions::Sparse ? &ReachingDefinitionAnalysis<ReachingInfo, true>::runSparseAlgorithm :
+					&ReachingDefinitionAnalysis<ReachingInfo, true>::runBlockWorklistAlgorithm);
+			return false;
+		}
+
+	};
+
+	/*
+	 * a module pass run the reaching defintion analysis on synthetic functions of growing size,
+	 * the input module is ignored
+	 */
+	struct ReachingDefinitionAnalysisBenchmarkPass : public ModulePass {
+		static char ID;
+
+		ReachingDefinitionAnalysisBenchmarkPass() : ModulePass(ID) {}
+
+		bool runOnModule(Module &M) override {
+			ReachingInfo bottom;
+			runBenchmark<ReachingDefinitionAnalysis<ReachingInfo, true>>(M.getContext(), "cse231-reaching", bottom, bottom,
+				DFAOptions::Sparse ? &ReachingDefinitionAnalysis<ReachingInfo, true>::runSparseAlgorithm :
+					&ReachingDefinitionAnalysis<ReachingInfo, true>::runBlockWorklistAlgorithm);
+			return false;
+		}
+
+	};
+
+	/*
+	 * a module pass check the incremental re-solve of the reaching definition analysis
+	 * after random edits against solving from scratch, the input module is not changed
+	 */
+	struct ReachingDefinitionIncrementalCheckPass : public ModulePass {
+		static char ID;
+
+		ReachingDefinitionIncrementalCheckPass() : ModulePass(ID) {}
+
+		bool runOnModule(Module &M) override {
+			ReachingInfo bottom;
+			runIncrementalCheck<ReachingDefinitionAnalysis<ReachingInfo, true>>(M, "cse231-reaching", bottom, bottom);
 			return false;
 		}
 
@@ -139,4 +276,10 @@ namespace {
 };
 
 char ReachingDefinitionAnalysisPass::ID = 0;
+char ReachingDefinitionAnalysisModulePass::ID = 0;
+char ReachingDefinitionAnalysisBenchmarkPass::ID = 0;
+char ReachingDefinitionIncrementalCheckPass::ID = 0;
 static RegisterPass<ReachingDefinitionAnalysisPass> X("cse231-reaching", false, false);
+static RegisterPass<ReachingDefinitionAnalysisModulePass> Y("cse231-reaching-parallel", false, false);
+static RegisterPass<ReachingDefinitionAnalysisBenchmarkPass> Z("cse231-reaching-benchmark", false, false);
+static RegisterPass<ReachingDefinitionIncrementalCheckPass> W("cse231-reaching-incremental-check", false, false);
@@ -0,0 +1,181 @@
+//===- 231BDD.h - Binary decision diagrams for CSE 231 projects ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides a small package of reduced ordered binary decision
+// diagrams, to represent large sets of integer tuples with shared structure.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_231BDD_H
+#define LLVM_TRANSFORMS_231BDD_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+
+/*
+ * Reduced ordered binary decision diagrams in one node table shared by all of them.
+ *
+ * A diagram is the index of its root node: 0 is the empty set, 1 the set of all the
+ * assignments. The nodes are unique, so two equal sets are the same index and two
+ * overlapping sets share their common nodes. Variable v is tested before variable v + 1.
+ *
+ * An integer of Bits bits is encoded on the variables First, ..., First + Bits - 1,
+ * the most significant bit first. The nodes are never freed; unite memoizes its results
+ * until the cache grows past CacheLimit entries.
+ *
+ * The table is shared by the threads of the parallel passes: every public function
+ * takes the lock.
+ */
+class BDD {
+	struct Node {
+		unsigned Var, Low, High;
+	};
+
+	enum : unsigned { Terminal = ~0u, CacheLimit = 1 << 20 };
+
+	std::vector<Node> Nodes;
+	DenseMap<std::tuple<unsigned, unsigned, unsigned>, unsigned> Unique;
+	DenseMap<std::pair<unsigned, unsigned>, unsigned> UnionCache;
+	std::mutex Lock;
+	uint64_t Unions = 0, UnionHits = 0;
+
+	BDD() {
+		Nodes.push_back({Terminal, 0, 0});
+		Nodes.push_back({Terminal, 1, 1});
+	}
+
+	unsigned var(unsigned f) const {
+		return Nodes[f].Var;
+	}
+
+	unsigned makeNode(unsigned var, unsigned low, unsigned high) {
+		if (low == high)
+			return low;
+		auto it = Unique.find(std::make_tuple(var, low, high));
+		if (it != Unique.end())
+			return it->second;
+		Nodes.push_back({var, low, high});
+		return Unique[std::make_tuple(var, low, high)] = Nodes.size() - 1;
+	}
+
+	unsigned uniteNodes(unsigned f, unsigned g) {
+		if (f == 0 || f == 1 || f == g)
+			return f == 0 ? g : f;
+		if (g == 0 || g == 1)
+			return g == 0 ? f : g;
+		if (f > g)
+			std::swap(f, g);
+		++Unions;
+		auto it = UnionCache.find(std::make_pair(f, g));
+		if (it != UnionCache.end()) {
+			++UnionHits;
+			return it->second;
+		}
+
+		unsigned v = std::min(var(f), var(g));
+		unsigned fLow = var(f) == v ? Nodes[f].Low : f, fHigh = var(f) == v ? Nodes[f].High : f;
+		unsigned gLow = var(g) == v ? Nodes[g].Low : g, gHigh = var(g) == v ? Nodes[g].High : g;
+		unsigned low = uniteNodes(fLow, gLow);
+		unsigned high = uniteNodes(fHigh, gHigh);
+		unsigned result = makeNode(v, low, high);
+		if (UnionCache.size() >= CacheLimit)
+			UnionCache.clear();
+		UnionCache[std::make_pair(f, g)] = result;
+		return result;
+	}
+
+	// the set of values[0..n), sorted and distinct, followed by the diagram rest
+	unsigned buildSorted(const unsigned * values, size_t n, unsigned first, unsigned bits, unsigned bit, unsigned rest) {
+		if (n == 0)
+			return 0;
+		if (bit == bits)
+			return rest;
+		unsigned mask = 1u << (bits - 1 - bit);
+		size_t split = std::partition_point(values, values + n, [&](unsigned value) { return !(value & mask); }) - values;
+		unsigned low = buildSorted(values, split, first, bits, bit + 1, rest);
+		unsigned high = buildSorted(values + split, n - split, first, bits, bit + 1, rest);
+		return makeNode(first + bit, low, high);
+	}
+
+	void enumerateNodes(unsigned f, unsigned first, unsigned bits, unsigned bit, unsigned value,
+											std::vector<std::pair<unsigned, unsigned>> & result) {
+		if (f == 0)
+			return;
+		if (bit == bits) {
+			result.push_back(std::make_pair(value, f));
+			return;
+		}
+		unsigned mask = 1u << (bits - 1 - bit);
+		// a variable not tested takes both values
+		bool tested = var(f) == first + bit;
+		enumerateNodes(tested ? Nodes[f].Low : f, first, bits, bit + 1, value, result);
+		enumerateNodes(tested ? Nodes[f].High : f, first, bits, bit + 1, value | mask, result);
+	}
+
+  public:
+		// the table of the process
+		static BDD & get() {
+			static BDD table;
+			return table;
+		}
+
+		unsigned unite(unsigned f, unsigned g) {
+			std::lock_guard<std::mutex> guard(Lock);
+			return uniteNodes(f, g);
+		}
+
+		/*
+		 * The set of the sorted distinct values on the variables [first, first + bits),
+		 * each followed by the diagram rest on the variables after them.
+		 */
+		unsigned fromSorted(const std::vector<unsigned> & values, unsigned first, unsigned bits, unsigned rest = 1) {
+			std::lock_guard<std::mutex> guard(Lock);
+			return buildSorted(values.data(), values.size(), first, bits, 0, rest);
+		}
+
+		/*
+		 * The diagram on the variables after [first, first + bits) that follows value in f.
+		 */
+		unsigned restrict(unsigned f, unsigned value, unsigned first, unsigned bits) {
+			std::lock_guard<std::mutex> guard(Lock);
+			for (unsigned bit = 0; bit < bits && f > 1; ++bit) {
+				if (var(f) != first + bit)
+					continue;
+				f = value & (1u << (bits - 1 - bit)) ? Nodes[f].High : Nodes[f].Low;
+			}
+			return f;
+		}
+
+		/*
+		 * The values on the variables [first, first + bits) in f, in increasing order,
+		 * with the diagram that follows each of them.
+		 */
+		std::vector<std::pair<unsigned, unsigned>> enumerate(unsigned f, unsigned first, unsigned bits) {
+			std::lock_guard<std::mutex> guard(Lock);
+			std::vector<std::pair<unsigned, unsigned>> result;
+			enumerateNodes(f, first, bits, 0, 0, result);
+			return result;
+		}
+
+		void printStatistics(raw_ostream & OS = errs()) {
+			std::lock_guard<std::mutex> guard(Lock);
+			OS << "BDD nodes: " << Nodes.size() << ", unions: " << Unions << ", union cache hits: " << UnionHits << "\n";
+		}
+};
+
+}
+#endif // End LLVM_TRANSFORMS_231BDD_H
@@ -0,0 +1,511 @@
+//===- 231DFABench.h - Scaling benchmark for the CSE 231 framework -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file generates synthetic functions of controllable shape and size, and
+// runs an analysis built on 231DFA.h over them to show its asymptotic behavior.
+// It also checks the incremental re-solve of the framework against solving from
+// scratch, after random edits of such functions and of the input module.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_231DFABENCH_H
+#define LLVM_TRANSFORMS_231DFABENCH_H
+
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "231DFA.h"
+#include <random>
+
+namespace llvm {
+
+/*
+ * Command line options of the benchmark passes, see DFAOptionsBase.
+ */
+template <class T = void>
+struct DFABenchOptionsBase {
+	static cl::opt<unsigned> MaxSize;
+	static cl::opt<unsigned> TimeBudget;
+	static cl::opt<unsigned> MemoryBudget;
+	static cl::opt<unsigned> CheckRounds;
+	static cl::opt<unsigned> CheckSeed;
+};
+
+template <class T>
+cl::opt<unsigned> DFABenchOptionsBase<T>::MaxSize("cse231-dfa-bench-max",
+		cl::desc("Largest number of instructions of the benchmark functions"),
+		cl::init(1000000));
+
+template <class T>
+cl::opt<unsigned> DFABenchOptionsBase<T>::TimeBudget("cse231-dfa-bench-seconds",
+		cl::desc("Skip the benchmark runs expected to take longer than this (seconds)"),
+		cl::init(60));
+
+template <class T>
+cl::opt<unsigned> DFABenchOptionsBase<T>::MemoryBudget("cse231-dfa-bench-memory",
+		cl::desc("Skip the benchmark runs expected to use more memory than this (megabytes)"),
+		cl::init(2048));
+
+template <class T>
+cl::opt<unsigned> DFABenchOptionsBase<T>::CheckRounds("cse231-dfa-check-rounds",
+		cl::desc("Number of random edits per function of the incremental re-solve check"),
+		cl::init(40));
+
+template <class T>
+cl::opt<unsigned> DFABenchOptionsBase<T>::CheckSeed("cse231-dfa-check-seed",
+		cl::desc("Seed of the random edits of the incremental re-solve check"),
+		cl::init(1));
+
+typedef DFABenchOptionsBase<> DFABenchOptions;
+
+/*
+ * Generator of the synthetic functions of the benchmark. The shapes are:
+ *   straight:    one long basic block
+ *   loops:       loops nested 8 deep
+ *   switch:      a switch with one case per 16 instructions
+ *   irreducible: a chain of loops with two entries
+ *   phi:         phi nodes with one incoming value per 3 instructions
+ * The instructions in the blocks cycle through loads, stores, arithmetic, bitcasts
+ * and getelementptrs on a few allocas, so that every client analysis has work to do.
+ */
+class DFABenchmarkIR {
+	IRBuilder<> Builder;
+	Function * F;
+	// i32 and i32* allocas of the entry block, which dominate every use
+	std::vector<Value *> Ints, Slots;
+	// Instructions emitted by emitBody so far, which picks the next one
+	unsigned Counter;
+
+	DFABenchmarkIR(Function * f) : Builder(f->getContext()), F(f), Counter(0) {}
+
+	BasicBlock * newBlock() {
+		return BasicBlock::Create(F->getContext(), "", F);
+	}
+
+	Type * intTy() {
+		return Builder.getInt32Ty();
+	}
+
+	/*
+	 * Emit about n instructions at the end of the current block.
+	 * They only use the allocas and the values defined before them in the block.
+	 */
+	void emitBody(unsigned n) {
+		Value *value = nullptr, *pointer = nullptr;
+		for (unsigned k = 0; k < n; ++k) {
+			unsigned s = Counter++;
+			Value *a = Ints[s % Ints.size()], *b = Ints[s / 7 % Ints.size()], *slot = Slots[s % Slots.size()];
+			switch (s % 7) {
+				case 0:
+					value = Builder.CreateLoad(intTy(), a);
+					break;
+				case 1:
+					value = Builder.CreateAdd(value ? value : Builder.CreateLoad(intTy(), b), Builder.getInt32(1));
+					break;
+				case 2:
+					Builder.CreateStore(value ? value : Builder.getInt32(s), a);
+					break;
+				case 3:
+					pointer = Builder.CreateLoad(PointerType::getUnqual(intTy()), slot);
+					break;
+				case 4:
+					Builder.CreateStore(pointer ? pointer : b, slot);
+					break;
+				case 5:
+					Builder.CreateBitCast(pointer ? pointer : a, Builder.getInt8PtrTy());
+					break;
+				case 6:
+					pointer = Builder.CreateGEP(intTy(), pointer ? pointer : a, Builder.getInt32(1));
+					break;
+			}
+		}
+	}
+
+	/*
+	 * Emit a condition that is not known at compile time.
+	 */
+	Value * emitCondition() {
+		Value *value = Builder.CreateLoad(intTy(), Ints[Counter++ % Ints.size()]);
+		return Builder.CreateICmpSLT(value, Builder.getInt32(10));
+	}
+
+	/*
+	 * Emit the entry block with the allocas and return the block after it.
+	 */
+	BasicBlock * emitEntry() {
+		Builder.SetInsertPoint(newBlock());
+		for (int i = 0; i < 8; ++i) {
+			Ints.push_back(Builder.CreateAlloca(intTy()));
+			Slots.push_back(Builder.CreateAlloca(PointerType::getUnqual(intTy())));
+		}
+		BasicBlock *next = newBlock();
+		Builder.CreateBr(next);
+		return next;
+	}
+
+	void straight(unsigned size) {
+		Builder.SetInsertPoint(emitEntry());
+		emitBody(size);
+		Builder.CreateRetVoid();
+	}
+
+	void loops(unsigned size) {
+		const unsigned depth = 8;
+		unsigned body = std::max(1u, size / (2 * depth));
+		BasicBlock *pred = emitEntry(), *exit = newBlock();
+		std::vector<BasicBlock *> headers, bodies, latches;
+		for (unsigned l = 0; l < depth; ++l) {
+			headers.push_back(newBlock());
+			bodies.push_back(newBlock());
+			latches.push_back(newBlock());
+		}
+
+		Builder.SetInsertPoint(pred);
+		Builder.CreateBr(headers[0]);
+		for (unsigned l = 0; l < depth; ++l) {
+			// header: i = phi [0, outside], [i + 1, latch]; br i < 8, body, outer latch
+			Builder.SetInsertPoint(headers[l]);
+			PHINode *i = Builder.CreatePHI(intTy(), 2);
+			i->addIncoming(Builder.getInt32(0), l == 0 ? pred : bodies[l - 1]);
+			Builder.CreateCondBr(Builder.CreateICmpSLT(i, Builder.getInt32(8)), bodies[l], l == 0 ? exit : latches[l - 1]);
+
+			Builder.SetInsertPoint(bodies[l]);
+			emitBody(body);
+			Builder.CreateBr(l + 1 < depth ? headers[l + 1] : latches[l]);
+
+			Builder.SetInsertPoint(latches[l]);
+			emitBody(body);
+			Value *next = Builder.CreateAdd(i, Builder.getInt32(1));
+			i->addIncoming(next, latches[l]);
+			Builder.CreateBr(headers[l]);
+		}
+
+		Builder.SetInsertPoint(exit);
+		Builder.CreateRetVoid();
+	}
+
+	void switches(unsigned size) {
+		unsigned cases = std::max(2u, size / 16);
+		BasicBlock *entry = emitEntry(), *merge = newBlock();
+		Builder.SetInsertPoint(entry);
+		SwitchInst *sw = Builder.CreateSwitch(Builder.CreateLoad(intTy(), Ints[0]), merge, cases);
+		for (unsigned c = 0; c < cases; ++c) {
+			BasicBlock *block = newBlock();
+			sw->addCase(Builder.getInt32(c), block);
+			Builder.SetInsertPoint(block);
+			emitBody(15);
+			Builder.CreateBr(merge);
+		}
+		Builder.SetInsertPoint(merge);
+		Builder.CreateRetVoid();
+	}
+
+	void irreducible(unsigned size) {
+		const unsigned body = 16;
+		unsigned regions = std::max(1u, size / (2 * body + 6));
+		Builder.SetInsertPoint(emitEntry());
+		for (unsigned r = 0; r < regions; ++r) {
+			// entry -> a or b, a <-> b, both -> exit
+			BasicBlock *a = newBlock(), *b = newBlock(), *exit = newBlock();
+			Builder.CreateCondBr(emitCondition(), a, b);
+			Builder.SetInsertPoint(a);
+			emitBody(body);
+			Builder.CreateCondBr(emitCondition(), b, exit);
+			Builder.SetInsertPoint(b);
+			emitBody(body);
+			Builder.CreateCondBr(emitCondition(), a, exit);
+			Builder.SetInsertPoint(exit);
+		}
+		Builder.CreateRetVoid();
+	}
+
+	void phis(unsigned size) {
+		const unsigned width = 4;
+		unsigned preds = std::max(2u, size / 3);
+		BasicBlock *entry = emitEntry(), *merge = newBlock();
+		Builder.SetInsertPoint(entry);
+		SwitchInst *sw = Builder.CreateSwitch(Builder.CreateLoad(intTy(), Ints[0]), merge, preds);
+
+		Builder.SetInsertPoint(merge);
+		std::vector<PHINode *> ints, pointers;
+		for (unsigned k = 0; k < width; ++k) {
+			ints.push_back(Builder.CreatePHI(intTy(), preds + 1));
+			pointers.push_back(Builder.CreatePHI(PointerType::getUnqual(intTy()), preds + 1));
+			ints.back()->addIncoming(Builder.getInt32(0), entry);
+			pointers.back()->addIncoming(Ints[k], entry);
+		}
+		Builder.CreateRetVoid();
+
+		for (unsigned p = 0; p < preds; ++p) {
+			BasicBlock *block = newBlock();
+			sw->addCase(Builder.getInt32(p), block);
+			Builder.SetInsertPoint(block);
+			Value *a = Ints[p % Ints.size()];
+			Value *value = Builder.CreateLoad(intTy(), a);
+			Value *pointer = Builder.CreateGEP(intTy(), a, Builder.getInt32(1));
+			Builder.CreateBr(merge);
+			for (unsigned k = 0; k < width; ++k) {
+				ints[k]->addIncoming(value, block);
+				pointers[k]->addIncoming(pointer, block);
+			}
+		}
+	}
+
+  public:
+		static const std::vector<std::string> & shapes() {
+			static const std::vector<std::string> Shapes = {"straight", "loops", "switch", "irreducible", "phi"};
+			return Shapes;
+		}
+
+		/*
+		 * Add a function "bench" of the given shape with about size instructions to M.
+		 */
+		static Function * generate(Module * M, StringRef shape, unsigned size) {
+			FunctionType *type = FunctionType::get(Type::getVoidTy(M->getContext()), false);
+			Function *f = Function::Create(type, Function::ExternalLinkage, "bench", M);
+			DFABenchmarkIR generator(f);
+			if (shape == "straight")
+				generator.straight(size);
+			else if (shape == "loops")
+				generator.loops(size);
+			else if (shape == "switch")
+				generator.switches(size);
+			else if (shape == "irreducible")
+				generator.irreducible(size);
+			else
+				generator.phis(size);
+			return f;
+		}
+};
+
+/*
+ * Benchmark driver: run an analysis over the functions of every shape with
+ * 100, 300, 1000, ... instructions, up to -cse231-dfa-bench-max.
+ *   Name: the name of the analysis in the output.
+ *   Analysis, run: as in runOnModuleParallel.
+ *
+ * Each run writes one JSON object per line to OS: the solving time, the memory
+ * still allocated after solving, the peak number of live Info objects and the
+ * iteration counts of the framework. A shape stops growing when the next run,
+ * assuming at most quadratic growth, would exceed -cse231-dfa-bench-seconds or
+ * -cse231-dfa-bench-memory.
+ */
+template <class Analysis, class Info>
+void runBenchmark(LLVMContext & Context, StringRef Name, Info & bottom, Info & initialState,
+									void (Analysis::*run)(Function *), raw_ostream & OS = errs()) {
+	std::vector<unsigned> sizes;
+	for (uint64_t size = 100; size <= DFABenchOptions::MaxSize; size *= 10) {
+		sizes.push_back(size);
+		if (size * 3 <= DFABenchOptions::MaxSize)
+			sizes.push_back(size * 3);
+	}
+
+	for (const std::string & shape : DFABenchmarkIR::shapes()) {
+		for (int i = 0; i < sizes.size(); ++i) {
+			unsigned size = sizes[i];
+			Module M("cse231-dfa-benchmark", Context);
+			Function *F = DFABenchmarkIR::generate(&M, shape, size);
+			unsigned instructions = 0, blocks = F->size();
+			for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I)
+				++instructions;
+
+			double seconds = 0;
+			size_t before = sys::Process::GetMallocUsage(), bytes;
+			DFAStatistics stats;
+			{
+				Analysis analysis(bottom, initialState);
+				{
+					DFATimer timer(&seconds);
+					(analysis.*run)(F);
+				}
+				size_t after = sys::Process::GetMallocUsage();
+				bytes = after > before ? after - before : 0;
+				stats = analysis.getStatistics();
+			}
+
+			OS << "{\"analysis\": \"" << Name << "\", \"shape\": \"" << shape
+				 << "\", \"instructions\": " << instructions << ", \"blocks\": " << blocks
+				 << ", \"seconds\": " << format("%.6f", seconds) << ", \"bytes\": " << (uint64_t)bytes
+				 << ", \"peak_live_infos\": " << stats.PeakLiveInfos
+				 << ", \"worklist_pops\": " << stats.WorklistPops
+				 << ", \"flow_function_calls\": " << stats.FlowFunctionCalls
+				 << ", \"changed_edges\": " << stats.ChangedEdges << "}\n";
+			OS.flush();
+
+			if (i + 1 == sizes.size())
+				break;
+			double growth = (double)sizes[i + 1] / size * sizes[i + 1] / size;
+			if (seconds * growth > DFABenchOptions::TimeBudget ||
+					bytes * growth > (double)DFABenchOptions::MemoryBudget * (1 << 20))
+				break;
+		}
+	}
+}
+
+/*
+ * Random in-place edits of a function for the incremental re-solve check. They keep
+ * the IR valid: an operand is only replaced with a value of the same type that
+ * dominates it, and a branch is only pointed at a block without phi nodes.
+ */
+class DFARandomEdits {
+	Function * F;
+	std::mt19937 & Random;
+	std::vector<Instruction *> Instrs;
+	std::vector<BranchInst *> Branches;
+
+	unsigned pick(unsigned n) {
+		return Random() % n;
+	}
+
+	/*
+	 * Values of type ty that dominate the operands of I: the arguments, the instructions
+	 * of the entry block and the ones before I in its block. The operands of a phi node
+	 * are used in the predecessors, so they only get the first two.
+	 */
+	void candidates(Instruction * I, Type * ty, std::vector<Value *> * result) {
+		for (Argument & arg : F->args()) {
+			if (arg.getType() == ty)
+				result->push_back(&arg);
+		}
+		BasicBlock *entry = &F->getEntryBlock();
+		for (Instruction & J : *entry) {
+			if (&J == I || J.isTerminator())
+				break;
+			if (J.getType() == ty)
+				result->push_back(&J);
+		}
+		if (isa<PHINode>(I) || I->getParent() == entry)
+			return;
+		for (Instruction & J : *I->getParent()) {
+			if (&J == I)
+				break;
+			if (J.getType() == ty)
+				result->push_back(&J);
+		}
+	}
+
+  public:
+		DFARandomEdits(Function * f, std::mt19937 & random) : F(f), Random(random) {
+			for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+				Instrs.push_back(&*I);
+				if (BranchInst *br = dyn_cast<BranchInst>(&*I))
+					Branches.push_back(br);
+			}
+		}
+
+		/*
+		 * Replace an operand of a random instruction that is an argument or an instruction.
+		 * Return false if the picked operand could not be replaced.
+		 */
+		bool replaceOperand(std::vector<Instruction *> * changed) {
+			Instruction *I = Instrs[pick(Instrs.size())];
+			if (I->getNumOperands() == 0)
+				return false;
+			unsigned op = pick(I->getNumOperands());
+			Value *old = I->getOperand(op);
+			if (!isa<Instruction>(old) && !isa<Argument>(old))
+				return false;
+
+			std::vector<Value *> values;
+			candidates(I, old->getType(), &values);
+			if (values.empty())
+				return false;
+			Value *value = values[pick(values.size())];
+			if (value == old)
+				return false;
+			I->setOperand(op, value);
+			changed->push_back(I);
+			return true;
+		}
+
+		/*
+		 * Point a successor of a random branch at another block, which changes the CFG.
+		 */
+		bool retargetBranch(std::vector<Instruction *> * changed) {
+			if (Branches.empty() || F->size() < 2)
+				return false;
+			BranchInst *br = Branches[pick(Branches.size())];
+			BasicBlock *block = &*std::next(F->begin(), 1 + pick(F->size() - 1));
+			if (isa<PHINode>(block->front()))
+				return false;
+			br->setSuccessor(pick(br->getNumSuccessors()), block);
+			changed->push_back(br);
+			return true;
+		}
+};
+
+/*
+ * Randomized check of DataFlowAnalysis::updateWorklistAlgorithm.
+ *   Name, Analysis: as in runBenchmark.
+ *
+ * A copy of M, together with a synthetic function of every shape, is solved with
+ * runWorklistAlgorithm. Then each function gets -cse231-dfa-check-rounds random
+ * edits: one to three replaced operands, and every tenth time a retargeted branch,
+ * for which the indices are rebuilt. After each edit it is re-solved incrementally
+ * and compared with a new analysis that solves it from scratch, before and after
+ * every instruction. The mismatches and one summary line are written to OS, and the
+ * edits are reproducible with -cse231-dfa-check-seed. M itself is not changed.
+ */
+template <class Analysis, class Info>
+unsigned runIncrementalCheck(Module & M, StringRef Name, Info & bottom, Info & initialState,
+														 raw_ostream & OS = errs()) {
+	ValueToValueMapTy map;
+	std::unique_ptr<Module> copy = CloneModule(M, map);
+	for (const std::string & shape : DFABenchmarkIR::shapes())
+		DFABenchmarkIR::generate(copy.get(), shape, 300);
+
+	std::mt19937 random(DFABenchOptions::CheckSeed);
+	unsigned functions = 0, rounds = 0, structural = 0, mismatches = 0;
+	for (Function & F : *copy) {
+		if (F.isDeclaration())
+			continue;
+		++functions;
+		DFARandomEdits edits(&F, random);
+		Analysis analysis(bottom, initialState);
+		analysis.runWorklistAlgorithm(&F);
+
+		for (unsigned round = 0; round < DFABenchOptions::CheckRounds; ++round, ++rounds) {
+			std::vector<Instruction *> changed;
+			if (round % 10 == 9 && edits.retargetBranch(&changed)) {
+				++structural;
+			} else {
+				unsigned count = 1 + random() % 3;
+				for (unsigned tries = 0; changed.size() < count && tries < 20; ++tries)
+					edits.replaceOperand(&changed);
+			}
+			analysis.updateWorklistAlgorithm(&F, changed);
+
+			Analysis fresh(bottom, initialState);
+			fresh.runWorklistAlgorithm(&F);
+			for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+				for (int after = 0; after < 2; ++after) {
+					Info expected = after ? fresh.getFactAfter(&*I) : fresh.getFactBefore(&*I);
+					Info actual = after ? analysis.getFactAfter(&*I) : analysis.getFactBefore(&*I);
+					if (Info::equal(&expected, &actual))
+						continue;
+					++mismatches;
+					OS << "Mismatch in " << F.getName() << " after round " << round
+						 << (after ? ", after" : ", before") << *I << "\n  expected: ";
+					expected.print(OS);
+					OS << "  actual:   ";
+					actual.print(OS);
+				}
+			}
+		}
+	}
+
+	OS << "Incremental check: " << Name << ", " << functions << " functions, " << rounds << " rounds, "
+		 << structural << " of them structural, " << mismatches << " mismatches\n";
+	OS.flush();
+	return mismatches;
+}
+
+}
+#endif // End LLVM_TRANSFORMS_231DFABENCH_H
@@ -0,0 +1,538 @@
+#include "llvm/Pass.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cassert>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "231DFA.h"
+
+using namespace llvm;
+using namespace std;
+
+namespace {
+	/*
+	 * range [Lo, Hi] of the signed values of an integer of Bits bits
+	 */
+	struct Range {
+		int64_t Lo, Hi;
+		unsigned Bits;
+
+		bool operator==(const Range &other) const {
+			return Lo == other.Lo && Hi == other.Hi && Bits == other.Bits;
+		}
+
+		bool operator!=(const Range &other) const {
+			return !(*this == other);
+		}
+
+		static int64_t minOf(unsigned bits) {
+			return bits >= 64 ? INT64_MIN : -(int64_t(1) << (bits - 1));
+		}
+
+		static int64_t maxOf(unsigned bits) {
+			return bits >= 64 ? INT64_MAX : (int64_t(1) << (bits - 1)) - 1;
+		}
+
+		// all the values of the type
+		static Range full(unsigned bits) {
+			return {minOf(bits), maxOf(bits), bits};
+		}
+
+		// [lo, hi] if it fits in the type, otherwise the values wrap around and it is the full range
+		static Range make(int64_t lo, int64_t hi, unsigned bits) {
+			if (lo < minOf(bits) || hi > maxOf(bits))
+				return full(bits);
+			return {lo, hi, bits};
+		}
+
+		// [lo, hi] cut to the type: the values out of it are poison, e.g. the overflows of nsw operations
+		static Range clamp(int64_t lo, int64_t hi, unsigned bits) {
+			return {std::max(std::min(lo, maxOf(bits)), minOf(bits)), std::min(std::max(hi, minOf(bits)), maxOf(bits)), bits};
+		}
+
+		Range hull(const Range &other) const {
+			return {std::min(Lo, other.Lo), std::max(Hi, other.Hi), Bits};
+		}
+	};
+
+	/*
+	 * derived class of 231DFA.h/Info
+	 * represent information at each program point for interval analysis:
+	 * whether the point is reachable, and the range of each integer value defined before it
+	 */
+	class IntervalInfo : public Info {
+		public:
+			IntervalInfo() : reached(false) {}
+
+			void print(raw_ostream &OS = errs()) {
+				for (auto iter = ranges.begin(); iter != ranges.end(); ++iter)
+					OS << iter->first << ":[" << iter->second.Lo << "," << iter->second.Hi << "]|";
+				OS << "\n";
+			}
+
+			static bool equal(IntervalInfo *info1, IntervalInfo *info2) {
+				return info1->reached == info2->reached && info1->ranges == info2->ranges;
+			}
+
+			// hull of the ranges of each value
+			static IntervalInfo *join(IntervalInfo *info1, IntervalInfo *info2, IntervalInfo *result) {
+				if (result == nullptr)
+					result = new IntervalInfo();
+				for (IntervalInfo *info : {info1, info2}) {
+					if (info == result)
+						continue;
+					result->reached |= info->reached;
+					for (auto iter = info->ranges.begin(); iter != info->ranges.end(); ++iter) {
+						auto it = result->ranges.find(iter->first);
+						if (it == result->ranges.end())
+							result->ranges.insert(*iter);
+						else
+							it->second = it->second.hull(iter->second);
+					}
+				}
+				return result;
+			}
+
+			// hash of the ranges, for hash consing
+			static size_t hash(IntervalInfo *info) {
+				hash_code h = hash_value(info->reached);
+				for (auto iter = info->ranges.begin(); iter != info->ranges.end(); ++iter)
+					h = hash_combine(h, iter->first, iter->second.Lo, iter->second.Hi);
+				return h;
+			}
+
+			// write "+" or "-" for reached, then "index:lo:hi:bits;" per value, for the persistent cache
+			static void serialize(IntervalInfo *info, raw_ostream &OS) {
+				OS << (info->reached ? "+" : "-");
+				for (auto iter = info->ranges.begin(); iter != info->ranges.end(); ++iter)
+					OS << iter->first << ":" << iter->second.Lo << ":" << iter->second.Hi << ":" << iter->second.Bits << ";";
+			}
+
+			// read back the information written by serialize
+			static bool deserialize(StringRef text, IntervalInfo *result) {
+				if (text.empty() || (text[0] != '+' && text[0] != '-'))
+					return false;
+				result->reached = text[0] == '+';
+				SmallVector<StringRef, 16> entries;
+				text.substr(1).split(entries, ';', -1, false);
+				for (StringRef entry : entries) {
+					SmallVector<StringRef, 4> fields;
+					entry.split(fields, ':');
+					unsigned index;
+					Range range;
+					if (fields.size() != 4 || fields[0].getAsInteger(10, index) || fields[1].getAsInteger(10, range.Lo) ||
+							fields[2].getAsInteger(10, range.Hi) || fields[3].getAsInteger(10, range.Bits))
+						return false;
+					result->ranges[index] = range;
+				}
+				return true;
+			}
+
+			// a bound that grows jumps to the bound of the type
+			static void widen(IntervalInfo *old, IntervalInfo *next, IntervalInfo *result) {
+				*result = *next;
+				for (auto iter = result->ranges.begin(); iter != result->ranges.end(); ++iter) {
+					auto it = old->ranges.find(iter->first);
+					if (it == old->ranges.end())
+						continue;
+					Range &range = iter->second;
+					if (range.Lo < it->second.Lo)
+						range.Lo = Range::minOf(range.Bits);
+					if (range.Hi > it->second.Hi)
+						range.Hi = Range::maxOf(range.Bits);
+				}
+			}
+
+			// only the bounds of the type are improved
+			static void narrow(IntervalInfo *old, IntervalInfo *next, IntervalInfo *result) {
+				*result = *next;
+				for (auto iter = result->ranges.begin(); iter != result->ranges.end(); ++iter) {
+					auto it = old->ranges.find(iter->first);
+					if (it == old->ranges.end())
+						continue;
+					Range &range = iter->second;
+					if (it->second.Lo != Range::minOf(range.Bits))
+						range.Lo = it->second.Lo;
+					if (it->second.Hi != Range::maxOf(range.Bits))
+						range.Hi = it->second.Hi;
+				}
+			}
+
+			bool reached;
+			map<unsigned, Range> ranges;
+	};
+
+	/*
+	 * derived class of 231DFA.h/DataFlowAnalysis
+	 */
+	template<class Info, bool Direction>
+	class IntervalAnalysis: public DataFlowAnalysis<Info, Direction, IntervalAnalysis<Info, Direction>> {
+		// the framework calls flowfunction statically
+		friend class DataFlowAnalysis<Info, Direction, IntervalAnalysis>;
+
+		public:
+			IntervalAnalysis(Info &bottom, Info &initialState):
+				DataFlowAnalysis<Info, Direction, IntervalAnalysis>::DataFlowAnalysis(bottom, initialState) {
+				this->CacheID = "cse231-interval 1 " + to_string(DFAOptions::Narrowing);
+			}
+
+			~IntervalAnalysis() {}
+
+		private:
+			// number of bits of the integer values that have a range, 0 for the others
+			static unsigned trackedBits(Value *v) {
+				IntegerType *type = dyn_cast<IntegerType>(v->getType());
+				if (type == nullptr || type->getBitWidth() < 2 || type->getBitWidth() > 64)
+					return 0;
+				return type->getBitWidth();
+			}
+
+			// range of the integer value v in info; false if v is not defined on any path to this point
+			bool rangeOf(Info *info, Value *v, Range *range) {
+				unsigned bits = v->getType()->getIntegerBitWidth();
+				if (bits > 64)
+					bits = 64;
+				if (ConstantInt *c = dyn_cast<ConstantInt>(v)) {
+					if (c->getBitWidth() <= 64) {
+						int64_t value = c->getSExtValue();
+						*range = {value, value, bits};
+						return true;
+					}
+				}
+				Instruction *I = dyn_cast<Instruction>(v);
+				if (I != nullptr && trackedBits(I) != 0 && this->InstrToIndex.count(I)) {
+					auto it = info->ranges.find(this->InstrToIndex[I]);
+					if (it == info->ranges.end())
+						return false;
+					*range = it->second;
+					return true;
+				}
+				*range = Range::full(bits);
+				return true;
+			}
+
+			// range of an operand that dominates its use
+			Range operandRange(Info *info, Value *v) {
+				Range range;
+				if (!rangeOf(info, v, &range))
+					range = Range::full(std::min(v->getType()->getIntegerBitWidth(), 64u));
+				return range;
+			}
+
+			// x + y, x - y and x * y, the bound of int64_t they pass if they overflow
+			static int64_t saturatingAdd(int64_t x, int64_t y) {
+				int64_t result;
+				if (AddOverflow(x, y, result))
+					return y < 0 ? INT64_MIN : INT64_MAX;
+				return result;
+			}
+
+			static int64_t saturatingSub(int64_t x, int64_t y) {
+				int64_t result;
+				if (SubOverflow(x, y, result))
+					return y < 0 ? INT64_MAX : INT64_MIN;
+				return result;
+			}
+
+			static int64_t saturatingMul(int64_t x, int64_t y) {
+				int64_t result;
+				if (MulOverflow(x, y, result))
+					return (x < 0) != (y < 0) ? INT64_MIN : INT64_MAX;
+				return result;
+			}
+
+			// range of a binary operator of bits bits. with nsw, a signed overflow is poison and the
+			// range is cut to the type instead of wrapping; with nuw, a subtraction of non-negative
+			// values is non-negative
+			static Range binaryRange(unsigned opcode, const Range &a, const Range &b, unsigned bits, bool nsw, bool nuw) {
+				int64_t lo, hi;
+				switch (opcode) {
+					case Instruction::Add:
+						if (nsw)
+							return Range::clamp(saturatingAdd(a.Lo, b.Lo), saturatingAdd(a.Hi, b.Hi), bits);
+						if (AddOverflow(a.Lo, b.Lo, lo) || AddOverflow(a.Hi, b.Hi, hi))
+							return Range::full(bits);
+						return Range::make(lo, hi, bits);
+
+					case Instruction::Sub:
+						if (nuw && a.Lo >= 0 && b.Lo >= 0)
+							return Range::make(std::max(a.Lo - b.Hi, int64_t(0)), a.Hi - b.Lo, bits);
+						if (nsw)
+							return Range::clamp(saturatingSub(a.Lo, b.Hi), saturatingSub(a.Hi, b.Lo), bits);
+						if (SubOverflow(a.Lo, b.Hi, lo) || SubOverflow(a.Hi, b.Lo, hi))
+							return Range::full(bits);
+						return Range::make(lo, hi, bits);
+
+					case Instruction::Mul: {
+						int64_t products[4];
+						if (nsw) {
+							int64_t bounds[4] = {saturatingMul(a.Lo, b.Lo), saturatingMul(a.Lo, b.Hi),
+								saturatingMul(a.Hi, b.Lo), saturatingMul(a.Hi, b.Hi)};
+							return Range::clamp(*std::min_element(bounds, bounds + 4), *std::max_element(bounds, bounds + 4), bits);
+						}
+						if (MulOverflow(a.Lo, b.Lo, products[0]) || MulOverflow(a.Lo, b.Hi, products[1]) ||
+								MulOverflow(a.Hi, b.Lo, products[2]) || MulOverflow(a.Hi, b.Hi, products[3]))
+							return Range::full(bits);
+						return Range::make(*std::min_element(products, products + 4), *std::max_element(products, products + 4), bits);
+					}
+
+					case Instruction::SDiv:
+						if (b.Lo <= 0)
+							return Range::full(bits);
+						lo = std::min(a.Lo / b.Lo, a.Lo / b.Hi);
+						hi = std::max(a.Hi / b.Lo, a.Hi / b.Hi);
+						return Range::make(lo, hi, bits);
+
+					case Instruction::SRem: {
+						// |result| < |divisor|, with the sign of the dividend
+						if ((b.Lo <= 0 && b.Hi >= 0) || b.Lo == INT64_MIN)
+							return Range::full(bits);
+						int64_t m = std::max(std::abs(b.Lo), std::abs(b.Hi)) - 1;
+						return Range::make(a.Lo >= 0 ? 0 : std::max(a.Lo, -m), a.Hi <= 0 ? 0 : std::min(a.Hi, m), bits);
+					}
+
+					case Instruction::URem:
+						if (a.Lo < 0 || b.Lo <= 0)
+							return Range::full(bits);
+						return Range::make(0, std::min(a.Hi, b.Hi - 1), bits);
+
+					case Instruction::And:
+						// masking with a non-negative value gives a value between 0 and the mask
+						if (a.Lo >= 0 && b.Lo >= 0)
+							return Range::make(0, std::min(a.Hi, b.Hi), bits);
+						if (a.Lo >= 0 || b.Lo >= 0)
+							return Range::make(0, a.Lo >= 0 ? a.Hi : b.Hi, bits);
+						return Range::full(bits);
+
+					case Instruction::LShr: case Instruction::AShr:
+						if (a.Lo < 0 || b.Lo != b.Hi || b.Lo < 0 || b.Lo >= bits)
+							return Range::full(bits);
+						return Range::make(a.Lo >> b.Lo, a.Hi >> b.Lo, bits);
+
+					default:
+						return Range::full(bits);
+				}
+			}
+
+			// range of the value of instruction I
+			Range instrRange(Instruction *I, Info *info, unsigned bits) {
+				if (I->isBinaryOp()) {
+					bool nsw = isa<OverflowingBinaryOperator>(I) && I->hasNoSignedWrap();
+					bool nuw = isa<OverflowingBinaryOperator>(I) && I->hasNoUnsignedWrap();
+					return binaryRange(I->getOpcode(), operandRange(info, I->getOperand(0)), operandRange(info, I->getOperand(1)), bits, nsw, nuw);
+				}
+
+				switch (I->getOpcode()) {
+					case Instruction::SExt:
+						return operandRange(info, I->getOperand(0));
+
+					case Instruction::ZExt: {
+						Range range = operandRange(info, I->getOperand(0));
+						if (range.Lo >= 0)
+							return Range::make(range.Lo, range.Hi, bits);
+						return Range::make(0, range.Bits >= 63 ? INT64_MAX : (int64_t(1) << range.Bits) - 1, bits);
+					}
+
+					case Instruction::Trunc: {
+						Range range = operandRange(info, I->getOperand(0));
+						return Range::make(range.Lo, range.Hi, bits);
+					}
+
+					case Instruction::Select:
+						return operandRange(info, I->getOperand(1)).hull(operandRange(info, I->getOperand(2)));
+
+					default:
+						return Range::full(bits);
+				}
+			}
+
+			// restrict the ranges of the operands of cmp in info to the path where it is taken or not taken;
+			// return false if that path is infeasible
+			bool refine(Info *info, ICmpInst *cmp, bool taken) {
+				CmpInst::Predicate pred = taken ? cmp->getPredicate() : cmp->getInversePredicate();
+				Value *x = cmp->getOperand(0), *y = cmp->getOperand(1);
+				if (!x->getType()->isIntegerTy())
+					return true;
+				Range a, b;
+				if (!rangeOf(info, x, &a) || !rangeOf(info, y, &b) || a.Bits < 2)
+					return true;
+
+				// unsigned comparisons of non-negative values are signed comparisons
+				if (ICmpInst::isUnsigned(pred)) {
+					if (a.Lo < 0 || b.Lo < 0)
+						return true;
+					pred = ICmpInst::getSignedPredicate(pred);
+				}
+				if (pred == ICmpInst::ICMP_SGT || pred == ICmpInst::ICMP_SGE) {
+					pred = ICmpInst::getSwappedPredicate(pred);
+					std::swap(x, y);
+					std::swap(a, b);
+				}
+
+				Range a2 = a, b2 = b;
+				switch (pred) {
+					case ICmpInst::ICMP_SLT:
+						if (a.Lo == INT64_MAX || b.Hi == INT64_MIN)
+							return false;
+						a2.Hi = std::min(a.Hi, b.Hi - 1);
+						b2.Lo = std::max(b.Lo, a.Lo + 1);
+						break;
+					case ICmpInst::ICMP_SLE:
+						a2.Hi = std::min(a.Hi, b.Hi);
+						b2.Lo = std::max(b.Lo, a.Lo);
+						break;
+					case ICmpInst::ICMP_EQ:
+						a2.Lo = b2.Lo = std::max(a.Lo, b.Lo);
+						a2.Hi = b2.Hi = std::min(a.Hi, b.Hi);
+						break;
+					case ICmpInst::ICMP_NE:
+						// only a constant at a bound of the other range can be excluded
+						if (b.Lo == b.Hi && a.Lo == b.Lo && a.Lo < a.Hi)
+							++a2.Lo;
+						else if (b.Lo == b.Hi && a.Hi == b.Lo && a.Lo < a.Hi)
+							--a2.Hi;
+						else if (a.Lo == a.Hi && b.Lo == a.Lo && b.Lo < b.Hi)
+							++b2.Lo;
+						else if (a.Lo == a.Hi && b.Hi == a.Lo && b.Lo < b.Hi)
+							--b2.Hi;
+						else if (a.Lo == a.Hi && b.Lo == b.Hi && a.Lo == b.Lo)
+							return false;
+						break;
+					default:
+						return true;
+				}
+				if (a2.Lo > a2.Hi || b2.Lo > b2.Hi)
+					return false;
+
+				for (auto operand : {make_pair(x, a2), make_pair(y, b2)}) {
+					Instruction *I = dyn_cast<Instruction>(operand.first);
+					if (I != nullptr && trackedBits(I) != 0 && this->InstrToIndex.count(I))
+						info->ranges[this->InstrToIndex[I]] = operand.second;
+				}
+				return true;
+			}
+
+			virtual void flowfunction(Instruction *I, vector<unsigned> &IncomingEdges, vector<unsigned> &OutgoingEdges, vector<Info *> &Infos) {
+				if (I == nullptr)
+					return;
+				unsigned index = this->InstrToIndex[I];
+
+				// join incoming information
+				Info *temp = this->acquireInfo();
+				for (unsigned src : IncomingEdges) {
+					temp = Info::join(this->edgeInfo(src, index), temp, temp);
+				}
+
+				// case 1: unreachable		OUT = bottom
+				if (!temp->reached) {
+					this->releaseInfo(temp);
+					return;
+				}
+
+				// case 2: phi		for each phi, the hull of the incoming values on the edges they come from
+				if (isa<PHINode>(I)) {
+					for (auto ii = I->getIterator(), ie = I->getParent()->end(); ii != ie && isa<PHINode>(&*ii); ++ii) {
+						PHINode *phi = cast<PHINode>(&*ii);
+						unsigned bits = trackedBits(phi);
+						if (bits == 0)
+							continue;
+						bool found = false;
+						Range range;
+						for (unsigned src : IncomingEdges) {
+							if (this->IndexToInstr[src] == nullptr)
+								continue;
+							Info *edge = this->edgeInfo(src, index);
+							int k = phi->getBasicBlockIndex(this->IndexToInstr[src]->getParent());
+							Range incoming;
+							if (!edge->reached || k < 0 || !rangeOf(edge, phi->getIncomingValue(k), &incoming))
+								continue;
+							range = found ? range.hull(incoming) : incoming;
+							found = true;
+						}
+						if (found)
+							temp->ranges[this->InstrToIndex[phi]] = range;
+					}
+				}
+
+				// case 3: other instructions with an integer result
+				else if (unsigned bits = trackedBits(I)) {
+					temp->ranges[index] = instrRange(I, temp, bits);
+				}
+
+				// case 4: conditional branch on a comparison		refine the ranges on each outgoing edge
+				BranchInst *branch = dyn_cast<BranchInst>(I);
+				ICmpInst *cmp = branch && branch->isConditional() ? dyn_cast<ICmpInst>(branch->getCondition()) : nullptr;
+				if (cmp != nullptr && branch->getSuccessor(0) != branch->getSuccessor(1)) {
+					for (int i = 0; i < Infos.size(); ++i) {
+						bool taken = this->IndexToInstr[OutgoingEdges[i]]->getParent() == branch->getSuccessor(0);
+						Info refined = *temp;
+						if (refine(&refined, cmp, taken))
+							Info::join(Infos[i], &refined, Infos[i]);
+					}
+				} else {
+					for (int i = 0; i < Infos.size(); ++i)
+						Info::join(Infos[i], temp, Infos[i]);
+				}
+				this->releaseInfo(temp);
+			}
+	};
+
+	/*
+	 * a function pass do the interval analysis
+	 */
+	struct IntervalAnalysisPass : public FunctionPass {
+		static char ID;
+
+		IntervalAnalysisPass() : FunctionPass(ID) {}
+
+		bool runOnFunction(Function &F) override {
+			IntervalInfo bottom, initialState;
+			initialState.reached = true;
+			IntervalAnalysis<IntervalInfo, true> ia(bottom, initialState);
+			ia.runWideningWorklistAlgorithm(&F);
+			ia.print();
+			if (DFAOptions::PrintStats)
+				ia.printStatistics();
+			ia.reportStatistics(&F);
+			return false;
+		}
+
+		bool doFinalization(Module &M) override {
+			DFAReport::printSlowest();
+			return false;
+		}
+
+	};
+
+	/*
+	 * a module pass do the interval analysis on all the functions in parallel
+	 */
+	struct IntervalAnalysisModulePass : public ModulePass {
+		static char ID;
+
+		IntervalAnalysisModulePass() : ModulePass(ID) {}
+
+		bool runOnModule(Module &M) override {
+			IntervalInfo bottom, initialState;
+			initialState.reached = true;
+			runOnModuleParallel<IntervalAnalysis<IntervalInfo, true>>(M, bottom, initialState,
+				&IntervalAnalysis<IntervalInfo, true>::runWideningWorklistAlgorithm);
+			return false;
+		}
+
+	};
+};
+
+char IntervalAnalysisPass::ID = 0;
+char IntervalAnalysisModulePass::ID = 0;
+static RegisterPass<IntervalAnalysisPass> X("cse231-interval", false, false);
+static RegisterPass<IntervalAnalysisModulePass> Y("cse231-interval-parallel", false, false);
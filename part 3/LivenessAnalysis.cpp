@@ -1,7 +1,13 @@
 #include "llvm/Pass.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/IR/Instruction.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Local.h"
 
 #include <cassert>
 #include <map>
@@ -9,6 +15,7 @@
 #include <string>
 
 #include "231DFA.h"
+#include "231DFABench.h"
 
 using namespace llvm;
 using namespace std;
@@ -22,10 +29,10 @@ namespace {
 		public:
 			LivenessInfo() {}
 
-			void print() {
+			void print(raw_ostream &OS = errs()) {
 				for (auto life : lives)
-					errs() << life << "|";
-				errs() << "\n";
+					OS << life << "|";
+				OS << "\n";
 			}
 
 			static bool equal(LivenessInfo *info1, LivenessInfo *info2) {
@@ -43,6 +50,39 @@ namespace {
 						result->lives.insert(life);
 				return result;
 			}
+
+			// hash of the lives, for hash consing
+			static size_t hash(LivenessInfo *info) {
+				return hash_combine_range(info->lives.begin(), info->lives.end());
+			}
+
+			// lives of result = (lives of in - lives of kill) + lives of gen
+			static void transfer(LivenessInfo *in, LivenessInfo *gen, LivenessInfo *kill, LivenessInfo *result) {
+				if (result != in)
+					result->lives = in->lives;
+				for (auto life : kill->lives)
+					result->lives.erase(life);
+				result->lives.insert(gen->lives.begin(), gen->lives.end());
+			}
+
+			// write the lives as in print, for the persistent cache
+			static void serialize(LivenessInfo *info, raw_ostream &OS) {
+				for (auto life : info->lives)
+					OS << life << "|";
+			}
+
+			// read back the lives written by serialize
+			static bool deserialize(StringRef text, LivenessInfo *result) {
+				SmallVector<StringRef, 16> items;
+				text.split(items, '|', -1, false);
+				for (StringRef item : items) {
+					unsigned life;
+					if (item.getAsInteger(10, life))
+						return false;
+					result->lives.insert(life);
+				}
+				return true;
+			}
 		
 		set<unsigned> lives;
 
@@ -50,12 +90,21 @@ namespace {
 
 	/*
 	 * derived class of 231DFA.h/DataFlowAnalysis
+	 *
+	 * strong liveness, for the dead code elimination: an instruction without side effects only
+	 * uses its operands if its result is live after it, so the values only used by dead ones,
+	 * e.g. a cycle of phi and arithmetic in a loop, are dead as well. the phi use an operand on
+	 * the edge from its incoming block
 	 */
 	template<class Info, bool Direction>
-	class LivenessAnalysis: public DataFlowAnalysis<Info, Direction> {
+	class LivenessAnalysis: public DataFlowAnalysis<Info, Direction, LivenessAnalysis<Info, Direction>> {
+		// the framework calls flowfunction and summarize statically
+		friend class DataFlowAnalysis<Info, Direction, LivenessAnalysis>;
+
 		public:
-			LivenessAnalysis(Info &bottom, Info &initialState):
-				DataFlowAnalysis<Info, Direction>::DataFlowAnalysis(bottom, initialState) {
+			LivenessAnalysis(Info &bottom, Info &initialState, bool strong = false):
+				DataFlowAnalysis<Info, Direction, LivenessAnalysis>::DataFlowAnalysis(bottom, initialState), Strong(strong) {
+				this->CacheID = Strong ? "cse231-liveness 1 strong" : "cse231-liveness 1";
 				for (auto iter = this->IndexToInstr.begin(); iter != this->IndexToInstr.end(); ++iter)
 					errs() << iter->first << " " << iter->second->getOpcodeName() << "\n";
 			}
@@ -64,7 +113,40 @@ namespace {
 				this->EdgeToInfo.clear();	
 			}
 
+			// true if the result of I may be used after it, with the demand-driven queries
+			bool queryLiveAfter(Instruction *I) {
+				Info fact = this->queryFactAfter(I);
+				return fact.lives.count(this->InstrToIndex[I]) > 0;
+			}
+
 		private:
+			bool Strong;
+
+			// with strong liveness, whether the instruction uses its operands even if its result is dead
+			bool isCritical(Instruction *I) {
+				return !Strong || !wouldInstructionBeTriviallyDead(I);
+			}
+
+			// whether the instruction defines a variable, except phi instructions
+			static bool isDefinition(unsigned opcode) {
+				switch (opcode) {
+					// case 1: binary operator
+					case Instruction::Add: case Instruction::FAdd: case Instruction::Sub: case Instruction::FSub:
+					case Instruction::Mul: case Instruction::FMul: case Instruction::UDiv: case Instruction::SDiv:
+					case Instruction::FDiv: case Instruction::URem: case Instruction::SRem: case Instruction::FRem:
+					// case 2: binary bitwise operator
+					case Instruction::Shl: case Instruction::LShr: case Instruction::AShr:
+					case Instruction::And: case Instruction::Or: case Instruction::Xor:
+					// case 3: compare
+					case Instruction::ICmp: case Instruction::FCmp:
+					// case 4: other instructions with result
+					case Instruction::Alloca: case Instruction::Load: case Instruction::GetElementPtr: case Instruction::Select:
+						return true;
+					default:
+						return false;
+				}
+			}
+
 			void addOperandsInfo(Instruction *I, Info *info) {
 				unsigned num = I->getNumOperands();
 				for (int i = 0; i < num; ++i) {
@@ -78,55 +160,37 @@ namespace {
 				if (I == nullptr)
 					return;
 				unsigned index = this->InstrToIndex[I];
-				string op = I->getOpcodeName();
+				unsigned opcode = I->getOpcode();
 
 				// join incoming information
-				Info *temp = new Info();
+				Info *temp = this->acquireInfo();
 				for (unsigned src : IncomingEdges) {
-					pair<unsigned, unsigned> e = make_pair(src, index);
-					temp = Info::join(this->EdgeToInfo[e], temp, temp);
-				}
-				
-				// case 1: binary operator
-				if (op == "add" || op == "fadd" || op == "sub" || op == "fsub" || op == "mul" || op == "fmul" ||
-					op == "udiv" || op == "sdiv" || op == "fdiv" || op == "urem" || op == "srem" || op == "frem") {
-					temp->lives.erase(index);
-					addOperandsInfo(I, temp);
-				}
-			
-				// case 2: binary bitwise operator
-				else if (op == "shl" || op == "lshr" || op == "ashr" || op == "and" || op == "or" || op == "xor") {	
-					temp->lives.erase(index);
-					addOperandsInfo(I, temp);
-				}
-
-				// case 3: compare
-				else if (op == "icmp" || op == "fcmp") {
-					temp->lives.erase(index);
-					addOperandsInfo(I, temp);
+					temp = Info::join(this->edgeInfo(src, index), temp, temp);
 				}
 				
-				// case 4: other instructions with result
-				else if (op == "alloca" || op == "load" || op == "getelementptr" || op == "select") {
-					temp->lives.erase(index);
-					addOperandsInfo(I, temp);
+				// case 1 - 4: instructions with result
+				if (isDefinition(opcode)) {
+					bool live = temp->lives.erase(index) > 0;
+					if (live || isCritical(I))
+						addOperandsInfo(I, temp);
 				}
 				
 				// case 5: phi instruction
-				else if (op == "phi") {
+				else if (opcode == Instruction::PHI) {
 					// 5.1 find the range of "phi" instructions
 					int start = index, end = index;
 					while (true) {
 						++end;
 						if (this->IndexToInstr.find(end) == this->IndexToInstr.end() ||
 								this->IndexToInstr[end] == nullptr ||
-								string(this->IndexToInstr[end]->getOpcodeName()) != "phi")
+								!isa<PHINode>(this->IndexToInstr[end]))
 							break;
 					}
 					
 					// 5.2 remove all "def" variables
+					vector<bool> live(end - start);
 					for (int idx = start; idx < end; ++idx) {
-						temp->lives.erase(idx);
+						live[idx - start] = temp->lives.erase(idx) > 0;
 						for (int j = 0; j < Infos.size(); ++j)
 							Infos[j]->lives.erase(idx);
 					}
@@ -135,6 +199,8 @@ namespace {
 					for (int idx = start; idx < end; ++idx) {
 						Instruction *J = this->IndexToInstr[idx];
 						unsigned num = J->getNumOperands();
+						if (Strong && !live[idx - start])
+							continue;
 						for (int j = 0; j < Infos.size(); ++j) {
 							int output = OutgoingEdges[j];
 							// for each output, only add variable coming from it
@@ -143,7 +209,8 @@ namespace {
 								if (this->IndexToInstr.find(output) != this->IndexToInstr.end() && 
 										this->IndexToInstr[output] != nullptr &&
 										this->InstrToIndex.find(var) != this->InstrToIndex.end() &&
-										this->IndexToInstr[output]->getParent() == var->getParent()) { // same label
+										this->IndexToInstr[output]->getParent() ==
+											(Strong ? cast<PHINode>(J)->getIncomingBlock(i) : var->getParent())) { // same label
 									Infos[j]->lives.insert(this->InstrToIndex[var]);
 								}
 							}
@@ -152,13 +219,64 @@ namespace {
 				}
 
 				// case 6: instructions without result
-				else
+				else if (isCritical(I) || temp->lives.count(index))
 					addOperandsInfo(I, temp);
 
 				for (int i = 0; i < Infos.size(); ++i)
 					Infos[i]->lives.insert(temp->lives.begin(), temp->lives.end());
-				delete temp;
-			}	
+				this->releaseInfo(temp);
+			}
+
+			// summary for the block-level engine: OUT = (IN - {index}) + operands
+			virtual bool summarize(Instruction *I, Info *Gen, Info *Kill) {
+				unsigned opcode = I->getOpcode();
+				if (opcode == Instruction::PHI || Strong)
+					return false;
+				if (isDefinition(opcode))
+					Kill->lives.insert(this->InstrToIndex[I]);
+				addOperandsInfo(I, Gen);
+				return true;
+			}
+
+			// facts for the sparse engine: OUT = (IN - {index}) + operands, as flowfunction
+			virtual bool sparseFacts(Instruction *I, vector<unsigned> &OutgoingEdges, vector<vector<unsigned>> *Gen, vector<unsigned> *Kill) {
+				// the uses of strong liveness depend on the information
+				if (Strong)
+					return false;
+				unsigned index = this->InstrToIndex[I];
+				unsigned opcode = I->getOpcode();
+
+				// phi instructions: kill all the phi of the block, the uses only go to corresponding path
+				if (opcode == Instruction::PHI) {
+					for (unsigned idx = index; this->IndexToInstr.find(idx) != this->IndexToInstr.end() &&
+							this->IndexToInstr[idx] != nullptr && isa<PHINode>(this->IndexToInstr[idx]); ++idx) {
+						Kill->push_back(idx);
+						Instruction *J = this->IndexToInstr[idx];
+						for (int j = 0; j < OutgoingEdges.size(); ++j) {
+							Instruction *output = this->IndexToInstr[OutgoingEdges[j]];
+							for (int i = 0; i < J->getNumOperands(); ++i) {
+								Instruction *var = (Instruction *)J->getOperand(i);
+								if (output != nullptr && this->InstrToIndex.find(var) != this->InstrToIndex.end() &&
+										output->getParent() == var->getParent())
+									(*Gen)[j].push_back(this->InstrToIndex[var]);
+							}
+						}
+					}
+					return true;
+				}
+
+				if (isDefinition(opcode))
+					Kill->push_back(index);
+				LivenessInfo uses;
+				addOperandsInfo(I, &uses);
+				for (vector<unsigned> &gen : *Gen)
+					gen.assign(uses.lives.begin(), uses.lives.end());
+				return true;
+			}
+
+			virtual void sparseInfo(const vector<unsigned> &Facts, Info *result) {
+				result->lives.insert(Facts.begin(), Facts.end());
+			}
 	};
 
 	/*
@@ -172,8 +290,216 @@ namespace {
 		bool runOnFunction(Function &F) override {
 			LivenessInfo bottom;
 			LivenessAnalysis<LivenessInfo, false> la(bottom, bottom);
-			la.runWorklistAlgorithm(&F);
+			if (DFAOptions::Sparse)
+				la.runSparseAlgorithm(&F);
+			else
+				la.runBlockWorklistAlgorithm(&F);
 			la.print();
+			if (DFAOptions::PrintStats)
+				la.printStatistics();
+			la.reportStatistics(&F);
+			return false;
+		}
+
+		bool doFinalization(Module &M) override {
+			DFAReport::printSlowest();
+			return false;
+		}
+
+	};
+
+	/*
+	 * a function pass print the variables live after each call,
+	 * solving only what the queries need instead of the whole function
+	 */
+	struct LivenessQueryPass : public FunctionPass {
+		static char ID;
+
+		LivenessQueryPass() : FunctionPass(ID) {}
+
+		bool runOnFunction(Function &F) override {
+			LivenessInfo bottom;
+			LivenessAnalysis<LivenessInfo, false> la(bottom, bottom);
+			la.initializeQueries(&F);
+			for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+				if (!isa<CallInst>(&*I))
+					continue;
+				LivenessInfo info = la.queryFactAfter(&*I);
+				errs() << *I << "\n";
+				info.print();
+			}
+			if (DFAOptions::PrintStats)
+				la.printStatistics();
+			la.reportStatistics(&F);
+			return false;
+		}
+
+	};
+
+	/*
+	 * a function pass remove the dead code with the strong liveness queries, until nothing changes:
+	 * the instructions without side effects whose result is not live after them, and the
+	 * stores to the allocas whose memory no instruction may read. the alias analyses answer
+	 * the reads, e.g. with the points-to sets of
+	 *   opt -load LivenessAnalysis.so -load MayPointToAnalysis.so -cse231-maypointto-aa -cse231-liveness-dce
+	 */
+	struct LivenessDCEPass : public FunctionPass {
+		static char ID;
+
+		LivenessDCEPass() : FunctionPass(ID), Removed(0), Stores(0), Rounds(0) {}
+
+		void getAnalysisUsage(AnalysisUsage &AU) const override {
+			AU.addRequired<AAResultsWrapperPass>();
+		}
+
+		bool runOnFunction(Function &F) override {
+			if (F.isDeclaration())
+				return false;
+			AAResults &AA = getAnalysis<AAResultsWrapperPass>().getAAResults();
+			unsigned removed = 0;
+			while (true) {
+				// the loads removed may leave an alloca that nothing reads
+				++Rounds;
+				unsigned stores = removeDeadStores(F, AA);
+				unsigned count = stores + removeDeadInstructions(F);
+				if (count == 0)
+					break;
+				Stores += stores;
+				removed += count;
+			}
+			Removed += removed;
+			return removed > 0;
+		}
+
+		bool doFinalization(Module &M) override {
+			if (DFAOptions::PrintStats)
+				errs() << "Dead code: " << Removed << " instructions removed, " << Stores << " of them stores, "
+					<< Rounds << " liveness rounds\n";
+			return false;
+		}
+
+		// remove the instructions without side effects whose result is not live after them,
+		// with the strong liveness of this round
+		unsigned removeDeadInstructions(Function &F) {
+			LivenessInfo bottom;
+			LivenessAnalysis<LivenessInfo, false> la(bottom, bottom, true);
+			la.initializeQueries(&F);
+			set<Instruction *> dead;
+			for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+				if (I->getType()->isVoidTy() || !wouldInstructionBeTriviallyDead(&*I))
+					continue;
+				if (!la.queryLiveAfter(&*I))
+					dead.insert(&*I);
+			}
+			if (DFAOptions::PrintStats)
+				la.printStatistics();
+
+			// a dead instruction used by a live one is kept, e.g. in the blocks the analysis does not reach
+			bool changed = true;
+			while (changed) {
+				changed = false;
+				for (auto it = dead.begin(); it != dead.end(); ) {
+					Instruction *I = *it++;
+					bool used = any_of(I->users(), [&](User *user) {
+						return dead.count(cast<Instruction>(user)) == 0;
+					});
+					if (used) {
+						dead.erase(I);
+						changed = true;
+					}
+				}
+			}
+
+			for (Instruction *I : dead)
+				I->dropAllReferences();
+			for (Instruction *I : dead)
+				I->eraseFromParent();
+			return dead.size();
+		}
+
+		// remove the stores to the allocas of F whose memory no instruction of F may read: it
+		// does not escape, and dies when F returns
+		static unsigned removeDeadStores(Function &F, AAResults &AA) {
+			vector<StoreInst *> stores;
+			map<AllocaInst *, bool> read;
+			for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+				StoreInst *store = dyn_cast<StoreInst>(&*I);
+				if (store == nullptr || !store->isSimple())
+					continue;
+				AllocaInst *alloca = dyn_cast<AllocaInst>(getUnderlyingObject(store->getPointerOperand()));
+				if (alloca == nullptr)
+					continue;
+				if (read.find(alloca) == read.end())
+					read[alloca] = isRead(F, alloca, AA);
+				if (!read[alloca])
+					stores.push_back(store);
+			}
+			for (StoreInst *store : stores)
+				store->eraseFromParent();
+			return stores.size();
+		}
+
+		static bool isRead(Function &F, AllocaInst *alloca, AAResults &AA) {
+			MemoryLocation memory = MemoryLocation::getBeforeOrAfter(alloca);
+			for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+				if (I->mayReadFromMemory() && isRefSet(AA.getModRefInfo(&*I, memory)))
+					return true;
+			}
+			return false;
+		}
+
+		unsigned Removed, Stores, Rounds;
+	};
+
+	/*
+	 * a module pass do the liveness analysis on all the functions in parallel
+	 */
+	struct LivenessAnalysisModulePass : public ModulePass {
+		static char ID;
+
+		LivenessAnalysisModulePass() : ModulePass(ID) {}
+
+		bool runOnModule(Module &M) override {
+			LivenessInfo bottom;
+			runOnModuleParallel<LivenessAnalysis<LivenessInfo, false>>(M, bottom, bottom,
+				DFAOptions::Sparse ? &LivenessAnalysis<LivenessInfo, false>::runSparseAlgorithm :
+					&LivenessAnalysis<LivenessInfo, false>::runBlockWorklistAlgorithm);
+			return false;
+		}
+
+	};
+
+	/*
+	 * a module pass run the liveness analysis on synthetic functions of growing size,
+	 * the input module is ignored
+	 */
+	struct LivenessAnalysisBenchmarkPass : public ModulePass {
+		static char ID;
+
+		LivenessAnalysisBenchmarkPass() : ModulePass(ID) {}
+
+		bool runOnModule(Module &M) override {
+			LivenessInfo bottom;
+			runBenchmark<LivenessAnalysis<LivenessInfo, false>>(M.getContext(), "cse231-liveness", bottom, bottom,
+				DFAOptions::Sparse ? &LivenessAnalysis<LivenessInfo, false>::runSparseAlgorithm :
+					&LivenessAnalysis<LivenessInfo, false>::runBlockWorklistAlgorithm);
+			return false;
+		}
+
+	};
+
+	/*
+	 * a module pass check the incremental re-solve of the liveness analysis after
+	 * random edits against solving from scratch, the input module is not changed
+	 */
+	struct LivenessIncrementalCheckPass : public ModulePass {
+		static char ID;
+
+		LivenessIncrementalCheckPass() : ModulePass(ID) {}
+
+		bool runOnModule(Module &M) override {
+			LivenessInfo bottom;
+			runIncrementalCheck<LivenessAnalysis<LivenessInfo, false>>(M, "cse231-liveness", bottom, bottom);
 			return false;
 		}
 
@@ -181,4 +507,14 @@ namespace {
 };
 
 char LivenessAnalysisPass::ID = 0;
+char LivenessAnalysisModulePass::ID = 0;
+char LivenessAnalysisBenchmarkPass::ID = 0;
+char LivenessQueryPass::ID = 0;
+char LivenessDCEPass::ID = 0;
+char LivenessIncrementalCheckPass::ID = 0;
 static RegisterPass<LivenessAnalysisPass> X("cse231-liveness", false, false);
+static RegisterPass<LivenessAnalysisModulePass> Y("cse231-liveness-parallel", false, false);
+static RegisterPass<LivenessAnalysisBenchmarkPass> Z("cse231-liveness-benchmark", false, false);
+static RegisterPass<LivenessQueryPass> W("cse231-liveness-query", false, false);
+static RegisterPass<LivenessDCEPass> V("cse231-liveness-dce", false, false);
+static RegisterPass<LivenessIncrementalCheckPass> U("cse231-liveness-incremental-check", false, false);
@@ -1,220 +1,1724 @@
 #include "llvm/Pass.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/ADT/SparseBitVector.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Instruction.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/IR/ValueMap.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Local.h"
 
 #include <cassert>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
 #include <algorithm>
 
+#include "231BDD.h"
 #include "231DFA.h"
+#include "231DFABench.h"
 
 using namespace llvm;
 using namespace std;
 
 namespace {
+	cl::opt<unsigned> FieldLimit("cse231-maypointto-fields",
+			cl::desc("Track the fields of the allocas at constant byte offsets below this limit, at most 255 (0: one memory per alloca)"),
+			cl::init(0));
+
+	cl::opt<bool> UseBDD("cse231-maypointto-bdd",
+			cl::desc("Represent the may-point-to information as binary decision diagrams"));
+
+	cl::opt<unsigned> StackLimit("cse231-heap2stack-size",
+			cl::desc("Largest allocation in bytes that -cse231-heap2stack moves to the stack"),
+			cl::init(1024));
+
+	cl::opt<bool> ModelCalls("cse231-maypointto-calls",
+			cl::desc("Model the heap allocated by each call site, the known library calls, and the memory escaping to unknown calls"));
+
+	// the library calls known by the may-point-to analyses
+	enum LibraryCall { OtherCall, Allocation, Reallocation, MemoryCopy, NoEffect };
+
+	// the library call I is, OtherCall for the indirect calls and the defined or unknown functions
+	LibraryCall classifyCall(Instruction *I) {
+		Function *callee = getCalledFunction(I);
+		if (callee == nullptr || !callee->isDeclaration())
+			return OtherCall;
+		switch (callee->getIntrinsicID()) {
+			case Intrinsic::not_intrinsic:
+				break;
+			case Intrinsic::memcpy: case Intrinsic::memcpy_inline: case Intrinsic::memmove:
+				return MemoryCopy;
+			// the variable arguments are read from memory the module does not see
+			case Intrinsic::vastart: case Intrinsic::vacopy:
+				return OtherCall;
+			// memset, lifetime markers, debug information... do not copy pointers
+			default:
+				return NoEffect;
+		}
+		return StringSwitch<LibraryCall>(callee->getName())
+			.Cases("malloc", "calloc", "valloc", "aligned_alloc", Allocation)
+			.Cases("strdup", "strndup", "_Znwm", "_Znam", Allocation)
+			.Cases("_ZnwmRKSt9nothrow_t", "_ZnamRKSt9nothrow_t", Allocation)
+			.Case("realloc", Reallocation)
+			.Cases("memcpy", "memmove", MemoryCopy)
+			.Cases("free", "_ZdlPv", "_ZdaPv", "_ZdlPvm", "_ZdaPvm", NoEffect)
+			.Default(OtherCall);
+	}
+
+	/*
+	 * pointers and memory are integer IDs: the kind of the name in the low bits
+	 * (R for a value, M for the memory of an alloca or allocation call, P for the memory of the k-th argument
+	 * of the caller, F for a field of an alloca) and its number above, so the text is only
+	 * built for printing. Mi is also the field at offset 0 of alloca i; F is printed Mi.offset,
+	 * or Mi.* for the unknown field that overlaps all the others
+	 */
+	struct MayPointToNames {
+			enum Kind { R = 0, M = 1, P = 2, F = 3 };
+			enum : unsigned { UnknownField = 255, FieldObjects = 1 << 22 };
+
+			static unsigned id(Kind kind, unsigned number) {
+				assert(number < (1u << 30) && "the number does not fit in the ID");
+				return number << 2 | kind;
+			}
+
+			// the field at offset of the memory of alloca object. the objects from FieldObjects on
+			// do not fit in the number of a field, all their fields are Mi
+			static unsigned field(unsigned object, unsigned offset) {
+				if (object >= FieldObjects)
+					return id(M, object);
+				return id(F, object << 8 | offset);
+			}
+
+			static char kindOf(unsigned id) {
+				return "RMPF"[id & 3];
+			}
+
+			static unsigned numberOf(unsigned id) {
+				return id >> 2;
+			}
+
+			// the alloca of an M or F name
+			static unsigned objectOf(unsigned id) {
+				return kindOf(id) == 'F' ? numberOf(id) >> 8 : numberOf(id);
+			}
+
+			static unsigned offsetOf(unsigned id) {
+				return numberOf(id) & 255;
+			}
+
+			static string name(unsigned id) {
+				if (kindOf(id) != 'F')
+					return kindOf(id) + to_string(numberOf(id));
+				unsigned offset = offsetOf(id);
+				return "M" + to_string(objectOf(id)) + "." + (offset == UnknownField ? "*" : to_string(offset));
+			}
+
+			// the ID of a name like "R12" or "M3.8", or false if it is malformed
+			static bool parse(StringRef text, unsigned *result) {
+				size_t kind = text.empty() ? StringRef::npos : StringRef("RMP").find(text[0]);
+				pair<StringRef, StringRef> parts = text.substr(1).split('.');
+				unsigned number, offset = UnknownField;
+				if (kind == StringRef::npos || parts.first.getAsInteger(10, number))
+					return false;
+				if (parts.second.empty()) {
+					*result = id((Kind)kind, number);
+					return true;
+				}
+				if (kind != M || (parts.second != "*" && (parts.second.getAsInteger(10, offset) || offset >= UnknownField)))
+					return false;
+				*result = field(number, offset);
+				return true;
+			}
+	};
+
 	/*
 	 * derived class of 231DFA.h/Info
 	 * represent information at each program point for liveness analysis
 	 */
-	class MayPointToInfo : public Info {
+	class MayPointToInfo : public Info, public MayPointToNames {
 		public:
 			MayPointToInfo() {}
 
-			void print() {
-				vector<pair<string, string>> data;
-				for (auto iter = pointdict.begin(); iter != pointdict.end(); ++iter) {
-					string ptr = iter->first;
-					for (string mem : iter->second) {
-						string message = ptr + "->(" + mem + "/)";
-						data.push_back(make_pair(ptr, message));
-					}
+			void print(raw_ostream &OS = errs()) {
+				// the order of the names was the order of the strings, then it is sorted by kind and number
+				vector<pair<string, unsigned>> ptrs;
+				for (auto iter = pointdict.begin(); iter != pointdict.end(); ++iter)
+					ptrs.push_back(make_pair(name(iter->first), iter->first));
+				sort(ptrs.begin(), ptrs.end());
+
+				struct Message {
+					char kind;
+					unsigned number;
+					string text;
+				};
+				vector<Message> data;
+				for (auto &ptr : ptrs) {
+					vector<string> mems;
+					for (unsigned mem : pointdict[ptr.second])
+						mems.push_back(name(mem));
+					sort(mems.begin(), mems.end());
+					for (string &mem : mems)
+						data.push_back({kindOf(ptr.second), numberOf(ptr.second), ptr.first + "->(" + mem + "/)"});
 				}
-				sort(data.begin(), data.end(), [](pair<string, string> &a, pair<string, string> &b) -> bool {
-					int xa = stoi(a.first.substr(1)), xb = stoi(b.first.substr(1));
-					return a.first[0] > b.first[0] || (a.first[0] == b.first[0] && xa < xb);
+				sort(data.begin(), data.end(), [](const Message &a, const Message &b) -> bool {
+					return a.kind > b.kind || (a.kind == b.kind && a.number < b.number);
 				});
 				for (int i = 0; i < data.size(); ++i)
-					errs() << data[i].second << "|";
-				errs() << "\n";
+					OS << data[i].text << "|";
+				OS << "\n";
 			}
 
 			static bool equal(MayPointToInfo *info1, MayPointToInfo *info2) {
-				if (info1->pointdict.size() != info2->pointdict.size())
-					return false;
-				for (auto iter = info1->pointdict.begin(); iter != info1->pointdict.end(); ++iter) {
-					string ptr = iter->first;
-					if (!info2->pointdict.count(ptr) || info1->pointdict[ptr] != info2->pointdict[ptr])
-						return false;
-				}
-				return true;
+				return info1->pointdict == info2->pointdict;
 			}
 
+			// word-wise union of the sets of each pointer
 			static MayPointToInfo *join(MayPointToInfo *info1, MayPointToInfo *info2, MayPointToInfo *result) {
 				if (result == nullptr)
 					result = new MayPointToInfo();
-				if (result != info1) {
-					for (auto iter = info1->pointdict.begin(); iter != info1->pointdict.end(); ++iter) {
-						string ptr = iter->first;
-						if (result->pointdict.count(ptr))
-							result->pointdict[ptr].insert(info1->pointdict[ptr].begin(), info1->pointdict[ptr].end());
-						else
-							result->pointdict[ptr] = info1->pointdict[ptr];
-					}
+				for (MayPointToInfo *info : {info1, info2}) {
+					if (info == result)
+						continue;
+					for (auto iter = info->pointdict.begin(); iter != info->pointdict.end(); ++iter)
+						result->pointdict[iter->first] |= iter->second;
+				}
+				return result;
+			}
+
+			// hash of the pointdict, for hash consing
+			static size_t hash(MayPointToInfo *info) {
+				hash_code h = hash_value(info->pointdict.size());
+				for (auto iter = info->pointdict.begin(); iter != info->pointdict.end(); ++iter)
+					h = hash_combine(h, iter->first, hash_combine_range(iter->second.begin(), iter->second.end()));
+				return h;
+			}
+
+			// write the pointdict as "ptr=mem,mem;ptr=mem", for the persistent cache
+			static void serialize(MayPointToInfo *info, raw_ostream &OS) {
+				for (auto iter = info->pointdict.begin(); iter != info->pointdict.end(); ++iter) {
+					if (iter != info->pointdict.begin())
+						OS << ";";
+					OS << name(iter->first) << "=";
+					for (auto mem = iter->second.begin(); mem != iter->second.end(); ++mem)
+						OS << (mem == iter->second.begin() ? "" : ",") << name(*mem);
 				}
-				if (result != info2) {
-					for (auto iter = info2->pointdict.begin(); iter != info2->pointdict.end(); ++iter) {
-						string ptr = iter->first;
-						if (result->pointdict.count(ptr))
-							result->pointdict[ptr].insert(info2->pointdict[ptr].begin(), info2->pointdict[ptr].end());
-						else
-							result->pointdict[ptr] = info2->pointdict[ptr];
+			}
+
+			// read back the pointdict written by serialize
+			static bool deserialize(StringRef text, MayPointToInfo *result) {
+				SmallVector<StringRef, 16> entries;
+				text.split(entries, ';', -1, false);
+				for (StringRef entry : entries) {
+					pair<StringRef, StringRef> ptr = entry.split('=');
+					unsigned key;
+					if (!parse(ptr.first, &key))
+						return false;
+					// a pointer may point to nothing
+					SparseBitVector<> &mems = result->pointdict[key];
+					SmallVector<StringRef, 16> items;
+					ptr.second.split(items, ',', -1, false);
+					for (StringRef item : items) {
+						unsigned mem;
+						if (!parse(item, &mem))
+							return false;
+						mems.set(mem);
 					}
 				}
+				return true;
+			}
+
+			// the accessors used by MayPointToAnalysis, as in MayPointToBDDInfo
+
+			// ptr -> X for X in mems
+			void addPointsTo(unsigned ptr, const SparseBitVector<> &mems) {
+				if (!mems.empty())
+					pointdict[ptr] |= mems;
+			}
+
+			void addPointsTo(unsigned ptr, unsigned mem) {
+				pointdict[ptr].set(mem);
+			}
+
+			// add to mems X for ptr -> X
+			void addPointees(unsigned ptr, SparseBitVector<> &mems) const {
+				auto it = pointdict.find(ptr);
+				if (it != pointdict.end())
+					mems |= it->second;
+			}
+
+			// call f(ptr, mems) for the pointers in [first, last) in increasing order
+			template<class Function>
+			void forEachPointer(unsigned first, unsigned last, Function f) const {
+				for (auto it = pointdict.lower_bound(first); it != pointdict.end() && it->first < last; ++it)
+					f(it->first, it->second);
+			}
+
+			map<unsigned, SparseBitVector<>> pointdict;
+	};
+
+	/*
+	 * the information of MayPointToInfo as one binary decision diagram of the relation
+	 * {(ptr, mem) | ptr -> mem}, the pointer on the variables [0, 32) and the memory on
+	 * [32, 64). the diagrams of all the edges share their nodes in the table of 231BDD.h, so
+	 * the copies of the information are one integer and the joins are unions of diagrams
+	 */
+	class MayPointToBDDInfo : public Info, public MayPointToNames {
+		public:
+			enum : unsigned { PtrVar = 0, MemVar = 32, Bits = 32 };
+
+			MayPointToBDDInfo() : Relation(0) {}
+
+			// the same information with sets
+			MayPointToInfo toSets() const {
+				MayPointToInfo sets;
+				forEachPointer(0, ~0u, [&](unsigned ptr, const SparseBitVector<> &mems) {
+					sets.pointdict[ptr] = mems;
+				});
+				return sets;
+			}
+
+			void print(raw_ostream &OS = errs()) {
+				toSets().print(OS);
+			}
+
+			static bool equal(MayPointToBDDInfo *info1, MayPointToBDDInfo *info2) {
+				return info1->Relation == info2->Relation;
+			}
+
+			static MayPointToBDDInfo *join(MayPointToBDDInfo *info1, MayPointToBDDInfo *info2, MayPointToBDDInfo *result) {
+				if (result == nullptr)
+					result = new MayPointToBDDInfo();
+				result->Relation = BDD::get().unite(result->Relation, BDD::get().unite(info1->Relation, info2->Relation));
 				return result;
 			}
 
-			map<string, set<string>> pointdict;
+			// the diagrams are unique
+			static size_t hash(MayPointToBDDInfo *info) {
+				return hash_value(info->Relation);
+			}
+
+			// the format of MayPointToInfo
+			static void serialize(MayPointToBDDInfo *info, raw_ostream &OS) {
+				MayPointToInfo sets = info->toSets();
+				MayPointToInfo::serialize(&sets, OS);
+			}
+
+			static bool deserialize(StringRef text, MayPointToBDDInfo *result) {
+				MayPointToInfo sets;
+				if (!MayPointToInfo::deserialize(text, &sets))
+					return false;
+				for (auto iter = sets.pointdict.begin(); iter != sets.pointdict.end(); ++iter)
+					result->addPointsTo(iter->first, iter->second);
+				return true;
+			}
+
+			// the accessors of MayPointToInfo
+
+			void addPointsTo(unsigned ptr, const SparseBitVector<> &mems) {
+				if (mems.empty())
+					return;
+				vector<unsigned> values;
+				for (unsigned mem : mems)
+					values.push_back(mem);
+				addRelation(ptr, BDD::get().fromSorted(values, MemVar, Bits));
+			}
+
+			void addPointsTo(unsigned ptr, unsigned mem) {
+				addRelation(ptr, BDD::get().fromSorted({mem}, MemVar, Bits));
+			}
+
+			void addPointees(unsigned ptr, SparseBitVector<> &mems) const {
+				unsigned set = BDD::get().restrict(Relation, ptr, PtrVar, Bits);
+				for (auto &mem : BDD::get().enumerate(set, MemVar, Bits))
+					mems.set(mem.first);
+			}
+
+			template<class Function>
+			void forEachPointer(unsigned first, unsigned last, Function f) const {
+				for (auto &ptr : BDD::get().enumerate(Relation, PtrVar, Bits)) {
+					if (ptr.first < first || ptr.first >= last)
+						continue;
+					SparseBitVector<> mems;
+					for (auto &mem : BDD::get().enumerate(ptr.second, MemVar, Bits))
+						mems.set(mem.first);
+					f(ptr.first, mems);
+				}
+			}
+
+			// the information is the node of the diagram
+			unsigned Relation;
+
+		private:
+			// ptr -> X for X in the diagram mems on the memory variables
+			void addRelation(unsigned ptr, unsigned mems) {
+				unsigned pairs = BDD::get().fromSorted({ptr}, PtrVar, Bits, mems);
+				Relation = BDD::get().unite(Relation, pairs);
+			}
 	};
 
 	/*
 	 * derived class of 231DFA.h/DataFlowAnalysis
 	 */
 	template<class Info, bool Direction>
-	class MayPointToAnalysis: public DataFlowAnalysis<Info, Direction> {
+	class MayPointToAnalysis: public DataFlowAnalysis<Info, Direction, MayPointToAnalysis<Info, Direction>> {
+		// the framework calls flowfunction statically
+		friend class DataFlowAnalysis<Info, Direction, MayPointToAnalysis>;
+
 		public:
 			MayPointToAnalysis(Info &bottom, Info &initialState):
-				DataFlowAnalysis<Info, Direction>::DataFlowAnalysis(bottom, initialState) {
+				DataFlowAnalysis<Info, Direction, MayPointToAnalysis>::DataFlowAnalysis(bottom, initialState) {
+				this->CacheID = "cse231-maypointto 2";
+				if (FieldLimit > 0)
+					this->CacheID += " fields " + to_string(std::min((unsigned)FieldLimit, (unsigned)Info::UnknownField));
+				if (ModelCalls)
+					this->CacheID += " calls";
 			}
 
 			~MayPointToAnalysis() {}
 
+			// the memory v may point to before I, with the demand-driven queries of the framework
+			SparseBitVector<> queryPointees(Instruction *I, Value *v) {
+				Info fact = this->queryFactBefore(I);
+				return pointees(&fact, v);
+			}
+
+			// true if the memory a and b may overlap: the same one, or a field of an alloca
+			// and the unknown field of the same alloca
+			static bool mayOverlap(unsigned a, unsigned b) {
+				if (a == b)
+					return true;
+				char kindA = Info::kindOf(a), kindB = Info::kindOf(b);
+				if ((kindA != 'M' && kindA != 'F') || (kindB != 'M' && kindB != 'F') || Info::objectOf(a) != Info::objectOf(b))
+					return false;
+				return (kindA == 'F' && Info::offsetOf(a) == Info::UnknownField) ||
+					(kindB == 'F' && Info::offsetOf(b) == Info::UnknownField);
+			}
+
 		private:
+			// add to mems the memory the value v may point to in IN: X for Rv -> X in IN if v is an instruction.
+			// In interprocedural mode, the k-th argument points to Pk, the memory of the caller.
+			void addPointees(Info *in, Value *v, SparseBitVector<> &mems) {
+				if (Instruction *var = dyn_cast<Instruction>(v)) {
+					auto it = this->InstrToIndex.find(var);
+					if (it != this->InstrToIndex.end())
+						in->addPointees(Info::id(Info::R, it->second), mems);
+				} else if (Argument *arg = dyn_cast<Argument>(v)) {
+					if (this->Summaries != nullptr)
+						mems.set(Info::id(Info::P, arg->getArgNo()));
+				}
+			}
+
+			SparseBitVector<> pointees(Info *in, Value *v) {
+				SparseBitVector<> mems;
+				addPointees(in, v, mems);
+				return mems;
+			}
+
+			// add to mems what the memory overlapping mem may point to in IN
+			static void addContents(Info *in, unsigned mem, SparseBitVector<> &mems) {
+				in->addPointees(mem, mems);
+				if (Info::kindOf(mem) != 'M' && Info::kindOf(mem) != 'F')
+					return;
+				unsigned object = Info::objectOf(mem), unknown = Info::field(object, Info::UnknownField);
+				if (mem != unknown) {
+					in->addPointees(unknown, mems);
+					return;
+				}
+				in->addPointees(Info::id(Info::M, object), mems);
+				in->forEachPointer(Info::field(object, 0), unknown, [&](unsigned ptr, const SparseBitVector<> &pointees) {
+					if (Info::kindOf(ptr) == 'F')
+						mems |= pointees;
+				});
+			}
+
+			// the fields the getelementptr I may point to when its base points to mems: the field at
+			// the constant offset of I from each field of an alloca, or the unknown field past the limit
+			static SparseBitVector<> fieldsOf(GetElementPtrInst *I, const SparseBitVector<> &mems) {
+				const DataLayout &DL = I->getModule()->getDataLayout();
+				APInt offset(DL.getIndexTypeSizeInBits(I->getType()), 0);
+				bool constant = cast<GEPOperator>(I)->accumulateConstantOffset(DL, offset);
+				int64_t limit = std::min((unsigned)FieldLimit, (unsigned)Info::UnknownField);
+
+				SparseBitVector<> fields;
+				for (unsigned mem : mems) {
+					char kind = Info::kindOf(mem);
+					if (kind != 'M' && kind != 'F') {
+						fields.set(mem);
+						continue;
+					}
+					unsigned object = Info::objectOf(mem);
+					int64_t base = kind == 'M' ? 0 : Info::offsetOf(mem);
+					int64_t target = base + offset.getSExtValue();
+					if (!constant || base == Info::UnknownField || target < 0 || target >= limit)
+						fields.set(Info::field(object, Info::UnknownField));
+					else if (target == 0)
+						fields.set(Info::id(Info::M, object));
+					else
+						fields.set(Info::field(object, target));
+				}
+				return fields;
+			}
+
+			// OUT = OUT + {ptr -> X | X in mems}
+			static void addPointsTo(Info *out, unsigned ptr, const SparseBitVector<> &mems) {
+				out->addPointsTo(ptr, mems);
+			}
+
+			// summary in interprocedural mode, in terms of the memory of the caller: Pk -> Pj if the
+			// function may make the memory passed as the k-th argument point to that passed as the j-th,
+			// and R0 -> Pj if it may return a pointer to it. Its own memory is dead after it returns,
+			// but not its heap: M0 is all of it, and becomes the memory of the call site in the caller.
+			virtual void summarizeFunction(Function *F, Info *Summary) {
+				for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+					ReturnInst *ret = dyn_cast<ReturnInst>(&*I);
+					if (ret == nullptr)
+						continue;
+					Info fact = this->getFactBefore(ret);
+					fact.forEachPointer(0, ~0u, [&](unsigned ptr, const SparseBitVector<> &mems) {
+						if (Info::kindOf(ptr) == 'P')
+							keepCallerMemory(ptr, mems, Summary);
+						else if (isHeap(ptr))
+							keepCallerMemory(Info::id(Info::M, 0), mems, Summary);
+					});
+					if (ret->getReturnValue() != nullptr)
+						keepCallerMemory(Info::id(Info::R, 0), pointees(&fact, ret->getReturnValue()), Summary);
+				}
+			}
+
+			// add ptr -> Pj to the summary for the memory Pj of the caller in mems, and ptr -> M0 for the heap
+			void keepCallerMemory(unsigned ptr, const SparseBitVector<> &mems, Info *Summary) {
+				for (unsigned mem : mems) {
+					if (Info::kindOf(mem) == 'P')
+						Summary->addPointsTo(ptr, mem);
+					else if (isHeap(mem))
+						Summary->addPointsTo(ptr, Info::id(Info::M, 0));
+				}
+			}
+
+			// true if mem is a field of the memory allocated by a call
+			bool isHeap(unsigned mem) {
+				if (Info::kindOf(mem) != 'M' && Info::kindOf(mem) != 'F')
+					return false;
+				auto it = this->IndexToInstr.find(Info::objectOf(mem));
+				return it != this->IndexToInstr.end() && it->second != nullptr && isa<CallBase>(it->second);
+			}
+
+			// the memory written through a pointer to mem without knowing where: the unknown
+			// field of its object with fields, else mem
+			static unsigned anyField(unsigned mem) {
+				if (FieldLimit == 0 || (Info::kindOf(mem) != 'M' && Info::kindOf(mem) != 'F'))
+					return mem;
+				return Info::field(Info::objectOf(mem), Info::UnknownField);
+			}
+
+			// call of a library function, or of a function without summary that may do anything
+			// with the memory reachable from its arguments
+			void modelCall(Info *temp, Instruction *I, unsigned index) {
+				CallBase *call = cast<CallBase>(I);
+				unsigned ptr = Info::id(Info::R, index);
+				switch (classifyCall(I)) {
+					// OUT = IN + {Ri -> Mi}
+					case Allocation:
+						temp->addPointsTo(ptr, Info::id(Info::M, index));
+						break;
+
+					// OUT = IN + {Ri -> Mi} + {Ri -> X | Rp -> X in IN} + {Mi -> Y | Rp -> X in IN and X -> Y in IN}
+					case Reallocation: {
+						SparseBitVector<> old = pointees(temp, call->getArgOperand(0)), mems;
+						for (unsigned x : old)
+							addContents(temp, anyField(x), mems);
+						addPointsTo(temp, anyField(Info::id(Info::M, index)), mems);
+						old.set(Info::id(Info::M, index));
+						addPointsTo(temp, ptr, old);
+						break;
+					}
+
+					// OUT = IN + {Y -> Z | Rdst -> Y in IN, Rsrc -> X in IN and X -> Z in IN} + {Ri -> Y | Rdst -> Y in IN}
+					case MemoryCopy: {
+						SparseBitVector<> dst = pointees(temp, call->getArgOperand(0)), mems;
+						for (unsigned x : pointees(temp, call->getArgOperand(1)))
+							addContents(temp, anyField(x), mems);
+						for (unsigned y : dst)
+							addPointsTo(temp, anyField(y), mems);
+						if (I->getType()->isPointerTy())
+							addPointsTo(temp, ptr, dst);
+						break;
+					}
+
+					case NoEffect:
+						break;
+
+					// the memory reachable from the arguments escapes: it may point to any of it, and so may Ri
+					case OtherCall: {
+						SparseBitVector<> reached, frontier;
+						for (Value *arg : call->args()) {
+							if (arg->getType()->isPointerTy())
+								addPointees(temp, arg, frontier);
+						}
+						while (!frontier.empty()) {
+							SparseBitVector<> next;
+							for (unsigned x : frontier) {
+								next.set(anyField(x));
+								addContents(temp, anyField(x), next);
+							}
+							reached |= frontier;
+							next.intersectWithComplement(reached);
+							frontier = next;
+						}
+						for (unsigned x : reached)
+							addPointsTo(temp, anyField(x), reached);
+						if (I->getType()->isPointerTy())
+							addPointsTo(temp, ptr, reached);
+						break;
+					}
+				}
+			}
+
 			virtual void flowfunction(Instruction *I, vector<unsigned> &IncomingEdges, vector<unsigned> &OutgoingEdges, vector<Info *> &Infos) {
 				if (I == nullptr)
 					return;
 				unsigned index = this->InstrToIndex[I];
-				string op = I->getOpcodeName();
 
 				// join incoming information
-				Info *temp = new Info();
+				Info *temp = this->acquireInfo();
 				for (unsigned src : IncomingEdges) {
-					pair<unsigned, unsigned> e = make_pair(src, index);
-					temp = Info::join(this->EdgeToInfo[e], temp, temp);
+					temp = Info::join(this->edgeInfo(src, index), temp, temp);
 				}
 
-				// case 1: alloca		OUT = IN + {Ri -> Mi}
-				if (op == "alloca") {
-					string ptr = "R" + to_string(index), mem = "M" + to_string(index);	
-					temp->pointdict[ptr].insert(mem);
-				}
+				unsigned ptr = Info::id(Info::R, index);
+				switch (I->getOpcode()) {
+					// case 1: alloca		OUT = IN + {Ri -> Mi}
+					case Instruction::Alloca: {
+						temp->addPointsTo(ptr, Info::id(Info::M, index));
+						break;
+					}
 				
-				// case 2: bitcast		OUT = IN + {Ri -> X | Rv -> X in IN}
-				else if (op == "bitcast") {
-					string ptr = "R" + to_string(index);
-					Instruction *var = (Instruction *)I->getOperand(0);
-					if (this->InstrToIndex.count(var)) {
-						unsigned v = this->InstrToIndex[var];
-						string rv = "R" + to_string(v);
-						temp->pointdict[ptr].insert(temp->pointdict[rv].begin(), temp->pointdict[rv].end());
+					// case 2: bitcast		OUT = IN + {Ri -> X | Rv -> X in IN}
+					case Instruction::BitCast: {
+						addPointsTo(temp, ptr, pointees(temp, I->getOperand(0)));
+						break;
 					}
-				}
 				
-				// case 3: getelementptr	OUT = IN + {Ri -> X | Rv -> X in IN}
-				else if (op == "getelementptr") {
-					string ptr = "R" + to_string(index);
-					Instruction *var = (Instruction *)I->getOperand(0);
-					if (this->InstrToIndex.count(var)) {
-						unsigned v = this->InstrToIndex[var];
-						string rv = "R" + to_string(v);
-						temp->pointdict[ptr].insert(temp->pointdict[rv].begin(), temp->pointdict[rv].end());
-					}
-				}
-
-				// case 4: load			OUT = IN + {Ri -> Y | Rp -> X in IN and X -> Y in IN}
-				else if (op == "load") {
-					if (I->getType()->isPointerTy()) {
-						string ptr = "R" + to_string(index);
-						Instruction *var = (Instruction *)I->getOperand(0);
-						if (this->InstrToIndex.count(var)) {
-							unsigned p = this->InstrToIndex[var];
-							string rp = "R" + to_string(p);
-							set<string> mems;
-							for (string x : temp->pointdict[rp])
-								mems.insert(temp->pointdict[x].begin(), temp->pointdict[x].end());
-							temp->pointdict[ptr].insert(mems.begin(), mems.end());
+					// case 3: getelementptr	OUT = IN + {Ri -> X | Rv -> X in IN}
+					//   with fields, OUT = IN + {Ri -> X.offset | Rv -> X in IN}
+					case Instruction::GetElementPtr: {
+						SparseBitVector<> mems = pointees(temp, I->getOperand(0));
+						if (FieldLimit > 0)
+							mems = fieldsOf(cast<GetElementPtrInst>(I), mems);
+						addPointsTo(temp, ptr, mems);
+						break;
+					}
+
+					// case 4: load			OUT = IN + {Ri -> Y | Rp -> X in IN and X' -> Y in IN, X' overlaps X}
+					case Instruction::Load: {
+						if (I->getType()->isPointerTy()) {
+							SparseBitVector<> mems;
+							for (unsigned x : pointees(temp, I->getOperand(0)))
+								addContents(temp, x, mems);
+							addPointsTo(temp, ptr, mems);
+						}
+						break;
+					}
+
+					// case 5: store		OUT = IN + {Y -> X | Rv - >X in IN and Rp -> Y in IN}
+					case Instruction::Store: {
+						SparseBitVector<> mems = pointees(temp, I->getOperand(0));
+						for (unsigned y : pointees(temp, I->getOperand(1)))
+							addPointsTo(temp, y, mems);
+						break;
+					}
+
+					// case 6: select		OUT = IN + {Ri -> X | R1 -> X in IN} + {Ri -> X | R2 -> X in IN}
+					case Instruction::Select: {
+						SparseBitVector<> mems = pointees(temp, I->getOperand(1));
+						addPointees(temp, I->getOperand(2), mems);
+						addPointsTo(temp, ptr, mems);
+						break;
+					}
+			
+					// case 7: phi			OUT = IN + {Ri -> X | Rk -> X in IN, k = 1, 2, ..., K}
+					case Instruction::PHI: {
+						int start = index, end = index;
+						while (true) {
+							++end;
+							if (this->IndexToInstr.find(end) == this->IndexToInstr.end() ||
+									this->IndexToInstr[end] == nullptr ||
+									!isa<PHINode>(this->IndexToInstr[end]))
+								break;
+						}
+					
+						for (int idx = start; idx < end; ++idx) {
+							SparseBitVector<> mems;
+							unsigned num = I->getNumOperands();
+							for (int k = 0; k < num; ++k)
+								addPointees(temp, I->getOperand(k), mems);
+							addPointsTo(temp, ptr, mems);
 						}
+						break;
 					}
+
+					// case 8: call with a summary of the callee, in interprocedural mode
+					//   OUT = IN + {Y -> map(X) | Pk -> X in summary, Y in map(Pk)} + {Ri -> map(X) | R0 -> X in summary}
+					//   where map(Pk) = {Y | Rv -> Y in IN} for the k-th argument v of the call, map(M0) = {Mi}
+					// other calls with -cse231-maypointto-calls, see modelCall
+					case Instruction::Call: case Instruction::Invoke: {
+						const Info *summary = this->getCalleeSummary(I);
+						if (summary == nullptr) {
+							if (ModelCalls)
+								modelCall(temp, I, index);
+							break;
+						}
+						auto actual = [&](unsigned name) {
+							if (Info::kindOf(name) == 'M') {
+								SparseBitVector<> heap;
+								heap.set(Info::id(Info::M, index));
+								return heap;
+							}
+							return pointees(temp, I->getOperand(Info::numberOf(name)));
+						};
+						summary->forEachPointer(0, ~0u, [&](unsigned name, const SparseBitVector<> &names) {
+							SparseBitVector<> mems;
+							for (unsigned x : names)
+								mems |= actual(x);
+							if (name == Info::id(Info::R, 0)) {
+								addPointsTo(temp, ptr, mems);
+							} else {
+								for (unsigned y : actual(name))
+									addPointsTo(temp, y, mems);
+							}
+						});
+						break;
+					}
+
+					// case 9: others		OUT = IN
+					default:
+						break;
+				}
+
+				for (int i = 0; i < Infos.size(); ++i)
+					Info::join(Infos[i], temp, Infos[i]);
+				this->releaseInfo(temp);
+			}	
+	};
+
+	/*
+	 * constraints of a flow-insensitive may-point-to analysis of a whole module
+	 *
+	 * they come from the instruction cases of MayPointToAnalysis, plus the direct calls, which
+	 * copy the actual arguments to the formal ones and the returned values to the call. a node is
+	 * a pointer value or a memory object (alloca, global, function); a solver gives the memory
+	 * objects each node may point to, for a memory object what is stored in it
+	 *
+	 * conservative constraints are sound for the whole program: the memory the module does not
+	 * track is the unknown object U, and U may point to U and to all the memory that escapes to it.
+	 * the values from the callers of external functions, unknown calls, integers and aggregates
+	 * point to U, and the memory they reach escapes
+	 */
+	class PointsToConstraints {
+		public:
+			PointsToConstraints(bool conservative = false) : Conservative(conservative), Escaped(NoNode), BuildTime(0), SolveTime(0) {}
+			virtual ~PointsToConstraints() {}
+
+			// generate the constraints of all the defined functions of M
+			void build(Module &M) {
+				DFATimer timer(&BuildTime);
+				for (GlobalVariable &G : M.globals()) {
+					if (G.hasInitializer())
+						addInitializer(G.getInitializer(), objectOf(&G));
+					// other modules may read and write it
+					if (Conservative && !G.hasLocalLinkage())
+						addAddressOf(escaped(), objectOf(&G));
+				}
+				for (Function &F : M) {
+					if (F.isDeclaration())
+						continue;
+					// unknown callers may pass anything and get the returned values
+					if (Conservative && (!F.hasLocalLinkage() || F.hasAddressTaken())) {
+						for (Argument &arg : F.args()) {
+							if (arg.getType()->isPointerTy())
+								copy(escaped(), getNode(&arg));
+						}
+						if (F.getReturnType()->isPointerTy())
+							copy(returnOf(&F), escaped());
+					}
+					for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I)
+						addConstraints(&*I);
+				}
+			}
+
+			void solve() {
+				DFATimer timer(&SolveTime);
+				solveConstraints();
+			}
+
+			// the memory objects the value v may point to
+			const SparseBitVector<> & pointsTo(Value *v) {
+				unsigned n = getNode(v);
+				return n == NoNode ? Empty : nodePointsTo(n);
+			}
+
+			// the memory objects the value v may point to, nullptr if v was not in the module when it was solved
+			const SparseBitVector<> * lookup(const Value *v) {
+				if (const ConstantExpr *ce = dyn_cast<ConstantExpr>(v)) {
+					if (ce->getOpcode() == Instruction::BitCast || ce->getOpcode() == Instruction::GetElementPtr)
+						return lookup(ce->getOperand(0));
+					return nullptr;
+				}
+				auto it = ValueToNode.find(const_cast<Value *>(v));
+				return it == ValueToNode.end() ? nullptr : &nodePointsTo(it->second);
+			}
+
+			// objects and what they may point to, transitively
+			SparseBitVector<> reachable(SparseBitVector<> objects) {
+				SparseBitVector<> frontier = objects;
+				while (!frontier.empty()) {
+					SparseBitVector<> next;
+					for (unsigned object : frontier)
+						next |= nodePointsTo(object);
+					next.intersectWithComplement(objects);
+					objects |= next;
+					frontier = next;
+				}
+				return objects;
+			}
+
+			// with conservative constraints, U and the memory escaping to it
+			SparseBitVector<> unknown() {
+				if (Escaped == NoNode)
+					return SparseBitVector<>();
+				SparseBitVector<> objects = nodePointsTo(Escaped);
+				objects.set(Escaped);
+				return objects;
+			}
+
+			// the memory objects that are not allocated by the instructions of F: U, the globals,
+			// the functions and the memory of the other functions
+			SparseBitVector<> objectsOutside(Function *F) {
+				SparseBitVector<> objects;
+				for (auto &it : ObjectToNode) {
+					Instruction *I = dyn_cast<Instruction>(it.first);
+					if (I == nullptr || I->getFunction() != F)
+						objects.set(it.second);
 				}
+				if (Escaped != NoNode)
+					objects.set(Escaped);
+				return objects;
+			}
+
+			// true if an instruction of F may point to more than one memory object, so that
+			// the flow-sensitive analysis may tell them apart
+			bool isAmbiguous(Function &F) {
+				for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+					const SparseBitVector<> &objects = pointsTo(&*I);
+					if (!objects.empty() && objects.find_first() != objects.find_last())
+						return true;
+				}
+				return false;
+			}
 
-				// case 5: store		OUT = IN + {Y -> X | Rv - >X in IN and Rp -> Y in IN}
-				else if (op == "store") {
-					Instruction *var0 = (Instruction *)I->getOperand(0), *var1 = (Instruction *)I->getOperand(1);
-					if (this->InstrToIndex.count(var0) && this->InstrToIndex.count(var1)) {
-						unsigned v = this->InstrToIndex[var0], p = this->InstrToIndex[var1];
-						string rv = "R" + to_string(v), rp = "R" + to_string(p);
-						set<string> mems;
-						for (string x : temp->pointdict[rv])
-							mems.insert(x);
-						for (string y : temp->pointdict[rp])
-							temp->pointdict[y].insert(mems.begin(), mems.end());
+			// for each function, "R<index>->(<memory>/)|" for the instructions that point to something and
+			// "M<index>->(<memory>/)|" for its allocas, with the indices of the flow-sensitive output
+			void print(Module &M, raw_ostream &OS = errs()) {
+				for (Function &F : M) {
+					if (F.isDeclaration())
+						continue;
+					OS << "Function " << F.getName() << ":";
+					unsigned index = 1;
+					for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I, ++index)
+						printSet("R" + to_string(index), pointsTo(&*I), &F, OS);
+					// then what is stored in the allocas of F
+					index = 1;
+					for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I, ++index) {
+						auto it = ObjectToNode.find(&*I);
+						if (it != ObjectToNode.end())
+							printSet("M" + to_string(index), nodePointsTo(it->second), &F, OS);
 					}
+					OS << "\n";
 				}
+			}
 
-				// case 6: select		OUT = IN + {Ri -> X | R1 -> X in IN} + {Ri -> X | R2 -> X in IN}
-				else if (op == "select") {
-					string ptr = "R" + to_string(index);
-					Instruction *var1 = (Instruction *)I->getOperand(1), *var2 = (Instruction *)I->getOperand(2);
-					set<string> mems;
-					if (this->InstrToIndex.count(var1)) {
-						string r1 = "R" + to_string(this->InstrToIndex[var1]);
-						mems.insert(temp->pointdict[r1].begin(), temp->pointdict[r1].end());
+			void printStatistics(Module &M, raw_ostream &OS = errs()) {
+				unsigned functions = 0, ambiguous = 0;
+				for (Function &F : M) {
+					if (!F.isDeclaration()) {
+						++functions;
+						ambiguous += isAmbiguous(F);
 					}
-					if (this->InstrToIndex.count(var2)) {
-						string r2 = "R" + to_string(this->InstrToIndex[var2]);
-						mems.insert(temp->pointdict[r2].begin(), temp->pointdict[r2].end());
+				}
+				OS << "Nodes: " << NodeToObject.size() << ", ";
+				printCounters(OS);
+				OS << ", ambiguous functions: " << ambiguous << "/" << functions << "\n";
+				OS << "Time: build " << format("%.6f", BuildTime) << "s, solve " << format("%.6f", SolveTime) << "s\n";
+			}
+
+		protected:
+			enum : unsigned { NoNode = ~0u };
+
+			// allocation of each memory object, nullptr for the other nodes
+			vector<Value *> NodeToObject;
+
+			// add a node to the solver, numbered NodeToObject.size() - 1
+			virtual void addNode() = 0;
+			// n -> object
+			virtual void addAddressOf(unsigned n, unsigned object) = 0;
+			// dst = src
+			virtual void addCopy(unsigned src, unsigned dst) = 0;
+			// dst = *p
+			virtual void addLoad(unsigned p, unsigned dst) = 0;
+			// *p = src
+			virtual void addStore(unsigned p, unsigned src) = 0;
+			virtual void solveConstraints() = 0;
+			virtual const SparseBitVector<> & nodePointsTo(unsigned n) = 0;
+			virtual void printCounters(raw_ostream &OS) = 0;
+
+			unsigned newNode(Value *object) {
+				NodeToObject.push_back(object);
+				addNode();
+				return NodeToObject.size() - 1;
+			}
+
+			const SparseBitVector<> Empty;
+
+		private:
+			bool Conservative;
+			// node of each value, forgotten if the value is deleted; memory object of each allocation
+			ValueMap<Value *, unsigned> ValueToNode;
+			DenseMap<Value *, unsigned> ObjectToNode;
+			// node of the returned values of each function
+			DenseMap<Function *, unsigned> ReturnNode;
+			// node of the memory escaping to unknown calls
+			unsigned Escaped;
+			double BuildTime, SolveTime;
+
+			unsigned objectOf(Value *v) {
+				auto it = ObjectToNode.find(v);
+				if (it != ObjectToNode.end())
+					return it->second;
+				return ObjectToNode[v] = newNode(v);
+			}
+
+			// node of a pointer value, NoNode for the values that point to nothing
+			unsigned getNode(Value *v) {
+				if (ConstantExpr *ce = dyn_cast<ConstantExpr>(v)) {
+					if (ce->getOpcode() == Instruction::IntToPtr)
+						return Conservative ? escaped() : NoNode;
+					if (ce->isCast() || ce->getOpcode() == Instruction::GetElementPtr)
+						return getNode(ce->getOperand(0));
+					return Conservative && ce->getType()->isPointerTy() ? escaped() : NoNode;
+				}
+				auto it = ValueToNode.find(v);
+				if (it != ValueToNode.end())
+					return it->second;
+				if (!isa<GlobalValue>(v) && !isa<Instruction>(v) && !isa<Argument>(v))
+					return NoNode;
+				unsigned n = ValueToNode[v] = newNode(nullptr);
+				// a global is the address of its memory
+				if (isa<GlobalValue>(v))
+					addAddressOf(n, objectOf(v));
+				return n;
+			}
+
+			unsigned returnOf(Function *F) {
+				auto it = ReturnNode.find(F);
+				if (it != ReturnNode.end())
+					return it->second;
+				return ReturnNode[F] = newNode(nullptr);
+			}
+
+			void copy(unsigned src, unsigned dst) {
+				if (src != NoNode && dst != NoNode)
+					addCopy(src, dst);
+			}
+
+			// U, node of the memory escaping to unknown calls: E = *E, *E = E, and E -> U if conservative
+			unsigned escaped() {
+				if (Escaped == NoNode) {
+					Escaped = newNode(nullptr);
+					addLoad(Escaped, Escaped);
+					addStore(Escaped, Escaped);
+					if (Conservative)
+						addAddressOf(Escaped, Escaped);
+				}
+				return Escaped;
+			}
+
+			// the pointers in the initializer of a global are stored in its memory, and with conservative
+			// constraints, the globals converted to integers escape
+			void addInitializer(Constant *init, unsigned object) {
+				if (init->getType()->isPointerTy()) {
+					copy(getNode(init), object);
+				} else if (isa<ConstantAggregate>(init)) {
+					for (Value *element : init->operands())
+						addInitializer(cast<Constant>(element), object);
+				} else if (Conservative) {
+					exposeConstant(init);
+				}
+			}
+
+			// the globals converted to integers in the constant c escape
+			void exposeConstant(Constant *c) {
+				ConstantExpr *ce = dyn_cast<ConstantExpr>(c);
+				if (ce == nullptr && !isa<ConstantAggregate>(c))
+					return;
+				if (ce != nullptr && ce->getOpcode() == Instruction::PtrToInt)
+					copy(getNode(ce->getOperand(0)), escaped());
+				for (Value *op : c->operands())
+					exposeConstant(cast<Constant>(op));
+			}
+
+			// with conservative constraints, the memory p points to is read as something else than
+			// pointers: what it may hold escapes, E = *Rp
+			void addContentsEscape(Value *p) {
+				unsigned n = getNode(p);
+				if (Conservative && n != NoNode)
+					addLoad(n, escaped());
+			}
+
+			static bool hasPointers(Type *type) {
+				if (type->isPtrOrPtrVectorTy())
+					return true;
+				for (Type *element : type->subtypes()) {
+					if (hasPointers(element))
+						return true;
+				}
+				return false;
+			}
+
+			// with conservative constraints, an instruction the cases do not model: its pointer
+			// operands escape, so does the memory it may read through them, and its pointer result
+			// may point to anything escaped
+			void addUnknown(Instruction *I) {
+				if (!Conservative)
+					return;
+				for (Value *op : I->operands()) {
+					if (!op->getType()->isPointerTy())
+						continue;
+					copy(getNode(op), escaped());
+					if (I->mayReadFromMemory())
+						addContentsEscape(op);
+				}
+				if (I->getType()->isPointerTy())
+					copy(escaped(), getNode(I));
+			}
+
+			void addConstraints(Instruction *I) {
+				if (Conservative) {
+					for (Value *op : I->operands()) {
+						if (Constant *c = dyn_cast<Constant>(op))
+							exposeConstant(c);
 					}
-					temp->pointdict[ptr].insert(mems.begin(), mems.end());
 				}
-			
-				// case 7: phi			OUT = IN + {Ri -> X | Rk -> X in IN, k = 1, 2, ..., K}
-				else if (op == "phi") {
-					int start = index, end = index;
-					while (true) {
-						++end;
-						if (this->IndexToInstr.find(end) == this->IndexToInstr.end() ||
-								this->IndexToInstr[end] == nullptr ||
-								string(this->IndexToInstr[end]->getOpcodeName()) != "phi")
+				switch (I->getOpcode()) {
+					// case 1: alloca		Ri -> Mi
+					case Instruction::Alloca: {
+						unsigned n = getNode(I), object = objectOf(I);
+						addAddressOf(n, object);
+						break;
+					}
+
+					// case 2, 3: bitcast, getelementptr		Ri = Rv
+					case Instruction::BitCast: case Instruction::GetElementPtr:
+						if (I->getType()->isPointerTy())
+							copy(getNode(I->getOperand(0)), getNode(I));
+						else if (hasPointers(I->getType()))
+							addUnknown(I);
+						break;
+
+					// case 4: load		Ri = *Rp
+					case Instruction::Load:
+						if (I->getType()->isPointerTy()) {
+							unsigned p = getNode(I->getOperand(0)), dst = getNode(I);
+							if (p != NoNode)
+								addLoad(p, dst);
+						} else if (hasPointers(I->getType())) {
+							// the pointers in aggregates are not tracked
+							addUnknown(I);
+						} else {
+							// the pointers read as integers are not tracked either
+							addContentsEscape(I->getOperand(0));
+						}
+						break;
+
+					// case 5: store		*Rp = Rv
+					case Instruction::Store:
+						if (I->getOperand(0)->getType()->isPointerTy()) {
+							unsigned p = getNode(I->getOperand(1)), v = getNode(I->getOperand(0));
+							if (p != NoNode && v != NoNode)
+								addStore(p, v);
+						} else if (hasPointers(I->getOperand(0)->getType())) {
+							addUnknown(I);
+						}
+						break;
+
+					// case 6, 7: select, phi		Ri = Rk for each incoming pointer
+					case Instruction::Select:
+						if (I->getType()->isPointerTy()) {
+							copy(getNode(I->getOperand(1)), getNode(I));
+							copy(getNode(I->getOperand(2)), getNode(I));
+						}
+						break;
+					case Instruction::PHI:
+						if (I->getType()->isPointerTy()) {
+							for (Value *incoming : cast<PHINode>(I)->incoming_values())
+								copy(getNode(incoming), getNode(I));
+						}
+						break;
+
+					// the comparisons and the instructions without pointers do not move pointers
+					case Instruction::ICmp:
+						break;
+
+					// case 8: direct call of a defined function		formal = actual, Ri = returned values
+					// other calls with -cse231-maypointto-calls, see addCallConstraints
+					case Instruction::Call: case Instruction::Invoke: {
+						Function *callee = getCalledFunction(I);
+						CallBase *call = cast<CallBase>(I);
+						if (callee == nullptr || callee->isDeclaration()) {
+							if (ModelCalls || Conservative)
+								addCallConstraints(call);
 							break;
+						}
+						for (unsigned k = 0; k < call->arg_size(); ++k) {
+							if (!call->getArgOperand(k)->getType()->isPointerTy())
+								continue;
+							// the variable arguments are not tracked
+							if (k < callee->arg_size())
+								copy(getNode(call->getArgOperand(k)), getNode(callee->getArg(k)));
+							else if (Conservative)
+								copy(getNode(call->getArgOperand(k)), escaped());
+						}
+						if (I->getType()->isPointerTy())
+							copy(returnOf(callee), getNode(I));
+						break;
 					}
-					
-					for (int idx = start; idx < end; ++idx) {
-						string ptr = "R" + to_string(index);
-						set<string> mems;
-						unsigned num = I->getNumOperands();
-						for (int k = 0; k < num; ++k) {
-							Instruction *vark = (Instruction *)I->getOperand(k);
-							if (this->InstrToIndex.count(vark)) {
-								string rk = "R" + to_string(this->InstrToIndex[vark]);
-								mems.insert(temp->pointdict[rk].begin(), temp->pointdict[rk].end());
+
+					case Instruction::Ret: {
+						Value *value = cast<ReturnInst>(I)->getReturnValue();
+						if (value != nullptr && value->getType()->isPointerTy())
+							copy(getNode(value), returnOf(I->getFunction()));
+						break;
+					}
+
+					// case 9: others, no constraint
+					default:
+						if (hasPointers(I->getType()) || any_of(I->operands(), [](Value *op) { return hasPointers(op->getType()); }))
+							addUnknown(I);
+						break;
+				}
+			}
+
+			// *dst = *src
+			void copyContents(Value *src, Value *dst) {
+				unsigned p = getNode(src), q = getNode(dst);
+				if (p == NoNode || q == NoNode)
+					return;
+				unsigned temp = newNode(nullptr);
+				addLoad(p, temp);
+				addStore(q, temp);
+			}
+
+			void addCallConstraints(CallBase *call) {
+				switch (classifyCall(call)) {
+					// Ri -> Mi
+					case Allocation: {
+						unsigned n = getNode(call), object = objectOf(call);
+						addAddressOf(n, object);
+						break;
+					}
+
+					// Ri -> Mi, Ri = Rp, *Ri = *Rp
+					case Reallocation: {
+						unsigned n = getNode(call), object = objectOf(call);
+						addAddressOf(n, object);
+						copy(getNode(call->getArgOperand(0)), n);
+						copyContents(call->getArgOperand(0), call);
+						break;
+					}
+
+					// *Rdst = *Rsrc, Ri = Rdst
+					case MemoryCopy:
+						copyContents(call->getArgOperand(1), call->getArgOperand(0));
+						if (call->getType()->isPointerTy())
+							copy(getNode(call->getArgOperand(0)), getNode(call));
+						break;
+
+					case NoEffect:
+						if (Conservative && call->getType()->isPointerTy())
+							copy(escaped(), getNode(call));
+						break;
+
+					// the memory reachable from the arguments escapes to a node E: E = Rv for each argument,
+					// E = *E, *E = E, Ri = E
+					case OtherCall: {
+						for (Value *arg : call->args()) {
+							if (arg->getType()->isPointerTy())
+								copy(getNode(arg), escaped());
+						}
+						if (call->getType()->isPointerTy())
+							copy(escaped(), getNode(call));
+						break;
+					}
+				}
+			}
+
+			void printSet(const string &name, const SparseBitVector<> &objects, Function *F, raw_ostream &OS) {
+				vector<string> mems;
+				for (unsigned object : objects)
+					mems.push_back(objectName(object, F));
+				sort(mems.begin(), mems.end());
+				for (string &mem : mems)
+					OS << name << "->(" << mem << "/)|";
+			}
+
+			// name of a memory object in the output of function F
+			string objectName(unsigned object, Function *F) {
+				Value *v = NodeToObject[object];
+				if (v == nullptr)
+					return "U";
+				if (isa<GlobalValue>(v))
+					return "@" + v->getName().str();
+				Instruction *I = cast<Instruction>(v);
+				unsigned index = 1;
+				for (inst_iterator J = inst_begin(I->getFunction()); &*J != I; ++J)
+					++index;
+				string name = "M" + to_string(index);
+				return I->getFunction() == F ? name : I->getFunction()->getName().str() + "." + name;
+			}
+	};
+
+	/*
+	 * inclusion-based (Andersen) solver of the points-to constraints
+	 *
+	 * the worklist uses difference propagation: a node only sends the part of its set that is
+	 * new since its last visit. cycles of copy edges are collapsed online with lazy cycle
+	 * detection: a search starts from an edge n -> z the first time both ends have the same set
+	 */
+	class AndersenSolver : public PointsToConstraints {
+		public:
+			AndersenSolver(bool conservative = false) : PointsToConstraints(conservative), Copies(0), Collapsed(0), Searches(0), Pops(0) {}
+
+		protected:
+			void addNode() override {
+				Rep.push_back(PointsTo.size());
+				PointsTo.emplace_back();
+				Sent.emplace_back();
+				CopyTo.emplace_back();
+				Loads.emplace_back();
+				Stores.emplace_back();
+				InWorklist.push_back(false);
+			}
+
+			void addAddressOf(unsigned n, unsigned object) override {
+				PointsTo[find(n)].set(object);
+			}
+
+			// a new edge sends the whole set of src
+			void addCopy(unsigned src, unsigned dst) override {
+				src = find(src);
+				dst = find(dst);
+				if (src == dst || !CopyTo[src].test_and_set(dst))
+					return;
+				++Copies;
+				if (PointsTo[dst] |= PointsTo[src])
+					push(dst);
+			}
+
+			void addLoad(unsigned p, unsigned dst) override {
+				Loads[find(p)].push_back(dst);
+			}
+
+			void addStore(unsigned p, unsigned src) override {
+				Stores[find(p)].push_back(src);
+			}
+
+			void solveConstraints() override {
+				for (unsigned n = 0; n < PointsTo.size(); ++n) {
+					if (!PointsTo[n].empty())
+						push(n);
+				}
+
+				while (!Worklist.empty()) {
+					unsigned n = Worklist.front();
+					Worklist.pop_front();
+					InWorklist[n] = false;
+					if (find(n) != n)
+						continue;
+					++Pops;
+
+					// the part of the set not sent yet
+					SparseBitVector<> delta = PointsTo[n];
+					delta.intersectWithComplement(Sent[n]);
+					Sent[n] = PointsTo[n];
+
+					// case load: dst = *n		case store: *n = src
+					for (unsigned object : delta) {
+						for (unsigned dst : Loads[n])
+							addCopy(object, dst);
+						for (unsigned src : Stores[n])
+							addCopy(src, object);
+					}
+
+					// case copy: the new edges got the whole set when they were added
+					vector<unsigned> cycles;
+					vector<unsigned> succs;
+					for (unsigned z : CopyTo[n])
+						succs.push_back(z);
+					for (unsigned z : succs) {
+						z = find(z);
+						if (z == n)
+							continue;
+						if (PointsTo[z] == PointsTo[n] && Checked.insert(make_pair(n, z)).second)
+							cycles.push_back(z);
+						if (PointsTo[z] |= delta)
+							push(z);
+					}
+					for (unsigned z : cycles)
+						collapseCycles(find(z));
+				}
+			}
+
+			const SparseBitVector<> & nodePointsTo(unsigned n) override {
+				return PointsTo[find(n)];
+			}
+
+			void printCounters(raw_ostream &OS) override {
+				OS << "copy constraints: " << Copies << ", collapsed nodes: " << Collapsed
+					 << ", cycle searches: " << Searches << ", worklist pops: " << Pops;
+			}
+
+		private:
+			// union-find of the collapsed nodes
+			vector<unsigned> Rep;
+			// points-to set, part of it already sent, and copy edges of each node
+			vector<SparseBitVector<>> PointsTo, Sent, CopyTo;
+			// Loads[p]: dst = *p		Stores[p]: *p = src
+			vector<vector<unsigned>> Loads, Stores;
+			// copy edges already searched for a cycle
+			set<pair<unsigned, unsigned>> Checked;
+			deque<unsigned> Worklist;
+			vector<bool> InWorklist;
+			unsigned Copies, Collapsed, Searches, Pops;
+
+			unsigned find(unsigned n) {
+				while (Rep[n] != n) {
+					Rep[n] = Rep[Rep[n]];
+					n = Rep[n];
+				}
+				return n;
+			}
+
+			void push(unsigned n) {
+				if (!InWorklist[n]) {
+					InWorklist[n] = true;
+					Worklist.push_back(n);
+				}
+			}
+
+			// merge b into a; the constraints of both are applied again to what only one of them sent
+			void merge(unsigned a, unsigned b) {
+				Rep[b] = a;
+				PointsTo[a] |= PointsTo[b];
+				Sent[a] &= Sent[b];
+				CopyTo[a] |= CopyTo[b];
+				Loads[a].insert(Loads[a].end(), Loads[b].begin(), Loads[b].end());
+				Stores[a].insert(Stores[a].end(), Stores[b].begin(), Stores[b].end());
+				PointsTo[b].clear();
+				Sent[b].clear();
+				CopyTo[b].clear();
+				Loads[b].clear();
+				Stores[b].clear();
+				++Collapsed;
+			}
+
+			// collapse the cycles of copy edges reachable from start, with Tarjan's algorithm
+			void collapseCycles(unsigned start) {
+				++Searches;
+				DenseMap<unsigned, unsigned> order, low;
+				vector<unsigned> stack;
+				DenseSet<unsigned> onStack;
+				// node and its successors not visited yet
+				vector<pair<unsigned, vector<unsigned>>> frames;
+				auto visit = [&](unsigned v) {
+					order[v] = low[v] = order.size();
+					stack.push_back(v);
+					onStack.insert(v);
+					vector<unsigned> succs;
+					for (unsigned w : CopyTo[v])
+						succs.push_back(find(w));
+					frames.push_back(make_pair(v, succs));
+				};
+
+				visit(start);
+				while (!frames.empty()) {
+					unsigned v = frames.back().first;
+					vector<unsigned> &succs = frames.back().second;
+					if (!succs.empty()) {
+						unsigned w = succs.back();
+						succs.pop_back();
+						if (w == v)
+							continue;
+						if (!order.count(w))
+							visit(w);
+						else if (onStack.count(w))
+							low[v] = std::min(low[v], order[w]);
+						continue;
+					}
+
+					frames.pop_back();
+					if (!frames.empty())
+						low[frames.back().first] = std::min(low[frames.back().first], low[v]);
+					if (low[v] == order[v]) {
+						unsigned w;
+						do {
+							w = stack.back();
+							stack.pop_back();
+							onStack.erase(w);
+							if (w != v)
+								merge(v, w);
+						} while (w != v);
+						if (find(v) == v && !Sent[v].contains(PointsTo[v]))
+							push(v);
+					}
+				}
+			}
+	};
+
+	/*
+	 * unification-based (Steensgaard) solver of the points-to constraints
+	 *
+	 * each class of the union-find points to at most one class, so a constraint unifies the
+	 * targets of both sides instead of adding an edge; the classes are merged as the constraints
+	 * are added, in almost linear time. less precise than Andersen: a pointer may point to every
+	 * memory object of its target class
+	 */
+	class SteensgaardSolver : public PointsToConstraints {
+		public:
+			SteensgaardSolver() : Unions(0) {}
+
+		protected:
+			void addNode() override {
+				Rep.push_back(Rep.size());
+				Rank.push_back(0);
+				Pointee.push_back(NoNode);
+			}
+
+			void addAddressOf(unsigned n, unsigned object) override {
+				n = find(n);
+				if (Pointee[n] == NoNode)
+					Pointee[n] = object;
+				else
+					unify(Pointee[n], object);
+			}
+
+			void addCopy(unsigned src, unsigned dst) override {
+				unify(pointee(dst), pointee(src));
+			}
+
+			void addLoad(unsigned p, unsigned dst) override {
+				unify(pointee(dst), pointee(pointee(p)));
+			}
+
+			void addStore(unsigned p, unsigned src) override {
+				unify(pointee(pointee(p)), pointee(src));
+			}
+
+			// the classes are already merged, collect their memory objects
+			void solveConstraints() override {
+				Members.clear();
+				for (unsigned n = 0; n < NodeToObject.size(); ++n) {
+					if (NodeToObject[n] != nullptr)
+						Members[find(n)].set(n);
+				}
+			}
+
+			const SparseBitVector<> & nodePointsTo(unsigned n) override {
+				unsigned target = Pointee[find(n)];
+				if (target == NoNode)
+					return Empty;
+				auto it = Members.find(find(target));
+				return it == Members.end() ? Empty : it->second;
+			}
+
+			void printCounters(raw_ostream &OS) override {
+				OS << "unions: " << Unions << ", classes with memory objects: " << Members.size();
+			}
+
+		private:
+			// union-find with union by rank, and the class each class points to
+			vector<unsigned> Rep, Rank, Pointee;
+			// memory objects of each class
+			map<unsigned, SparseBitVector<>> Members;
+			unsigned Unions;
+
+			unsigned find(unsigned n) {
+				while (Rep[n] != n) {
+					Rep[n] = Rep[Rep[n]];
+					n = Rep[n];
+				}
+				return n;
+			}
+
+			// the class n points to, a new empty one if none yet
+			unsigned pointee(unsigned n) {
+				n = find(n);
+				if (Pointee[n] == NoNode) {
+					unsigned target = newNode(nullptr);
+					Pointee[n] = target;
+				}
+				return find(Pointee[n]);
+			}
+
+			// merge the classes of a and b, then the classes they point to
+			void unify(unsigned a, unsigned b) {
+				vector<pair<unsigned, unsigned>> pending(1, make_pair(a, b));
+				while (!pending.empty()) {
+					a = find(pending.back().first);
+					b = find(pending.back().second);
+					pending.pop_back();
+					if (a == b)
+						continue;
+					if (Rank[a] < Rank[b])
+						swap(a, b);
+					else if (Rank[a] == Rank[b])
+						++Rank[a];
+					Rep[b] = a;
+					++Unions;
+					if (Pointee[a] == NoNode)
+						Pointee[a] = Pointee[b];
+					else if (Pointee[b] != NoNode)
+						pending.push_back(make_pair(Pointee[a], Pointee[b]));
+				}
+			}
+	};
+
+	/*
+	 * alias analysis answering from the conservative Andersen points-to sets of the whole module
+	 *
+	 * two pointers do not alias if they may only point to different memory objects, none of which
+	 * escapes to U; a call does not touch a memory object that it cannot reach from its arguments,
+	 * or for the calls that are not library calls, from the globals. the other queries go to the
+	 * next analysis of the chain
+	 */
+	class MayPointToAAResult : public AAResultBase<MayPointToAAResult> {
+		public:
+			MayPointToAAResult(Module &M) : Solver(true), Queries(0), NoAliases(0), ModRefQueries(0), NoModRefs(0) {
+				Solver.build(M);
+				Solver.solve();
+				Unknown = Solver.unknown();
+				SparseBitVector<> globals;
+				for (GlobalVariable &G : M.globals())
+					globals |= Solver.pointsTo(&G);
+				Globals = Solver.reachable(globals);
+			}
+
+			// the queries between two calls go to the chain
+			using AAResultBase::getModRefInfo;
+
+			AliasResult alias(const MemoryLocation &LocA, const MemoryLocation &LocB, AAQueryInfo &AAQI) {
+				++Queries;
+				const SparseBitVector<> *a = known(LocA.Ptr), *b = known(LocB.Ptr);
+				if (a != nullptr && b != nullptr && !a->intersects(*b)) {
+					++NoAliases;
+					return AliasResult::NoAlias;
+				}
+				return AAResultBase::alias(LocA, LocB, AAQI);
+			}
+
+			ModRefInfo getModRefInfo(const CallBase *Call, const MemoryLocation &Loc, AAQueryInfo &AAQI) {
+				++ModRefQueries;
+				const SparseBitVector<> *mems = known(Loc.Ptr);
+				if (mems != nullptr) {
+					SparseBitVector<> args;
+					for (const Value *arg : Call->args()) {
+						if (!arg->getType()->isPointerTy())
+							continue;
+						const SparseBitVector<> *objects = Solver.lookup(arg);
+						if (objects == nullptr)
+							return AAResultBase::getModRefInfo(Call, Loc, AAQI);
+						args |= *objects;
+					}
+					SparseBitVector<> reached = Solver.reachable(args);
+					if (classifyCall(const_cast<CallBase *>(Call)) == OtherCall)
+						reached |= Globals;
+					if (!mems->intersects(reached)) {
+						++NoModRefs;
+						return ModRefInfo::NoModRef;
+					}
+				}
+				return AAResultBase::getModRefInfo(Call, Loc, AAQI);
+			}
+
+			void printStatistics(raw_ostream &OS = errs()) {
+				OS << "Alias queries: " << Queries << ", no alias: " << NoAliases
+					 << ", call queries: " << ModRefQueries << ", no mod/ref: " << NoModRefs << "\n";
+			}
+
+		private:
+			AndersenSolver Solver;
+			// U and the memory escaping to it, the memory reachable from the globals
+			SparseBitVector<> Unknown, Globals;
+			unsigned Queries, NoAliases, ModRefQueries, NoModRefs;
+
+			// the memory objects ptr may point to, nullptr if they are not all known
+			const SparseBitVector<> * known(const Value *ptr) {
+				const SparseBitVector<> *mems = Solver.lookup(ptr);
+				if (mems == nullptr || mems->empty() || mems->intersects(Unknown))
+					return nullptr;
+				return mems;
+			}
+	};
+
+	/*
+	 * escape analysis of the heap allocations with the conservative Andersen constraints
+	 *
+	 * an allocation of constant size does not escape its function F if it is not in a cycle of F,
+	 * so that a call of F makes at most one of it, and its memory is not reachable from the memory
+	 * that outlives the call: U, the globals, the memory of the callers through the arguments of F,
+	 * the memory of the other functions, and the returned values. its frees must be in F and free
+	 * only it; nothing may reallocate it, and the library calls returning a pointer to it hide it
+	 */
+	class EscapeAnalysis {
+		public:
+			// an allocation of Size bytes that may be moved to the stack, and its frees
+			struct Promotion {
+				CallBase *Allocation;
+				uint64_t Size;
+				vector<CallBase *> Frees;
+			};
+
+			EscapeAnalysis(Module &M) : Solver(true) {
+				Solver.build(M);
+				Solver.solve();
+				for (Function &F : M) {
+					for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+						CallBase *call = dyn_cast<CallBase>(&*I);
+						if (call == nullptr)
+							continue;
+						if (isDeallocation(call)) {
+							Frees.push_back(call);
+						} else if (classifyCall(call) == Reallocation) {
+							Hidden |= Solver.pointsTo(call->getArgOperand(0));
+						} else if (classifyCall(call) == NoEffect && call->getType()->isPointerTy()) {
+							for (Value *arg : call->args()) {
+								if (arg->getType()->isPointerTy())
+									Hidden |= Solver.pointsTo(arg);
 							}
 						}
-						temp->pointdict[ptr].insert(mems.begin(), mems.end());
 					}
 				}
+			}
 
-				// case 8: others		OUT = IN
-				else {
-					;
+			// the allocations of F that may be moved to the stack
+			vector<Promotion> findPromotions(Function &F) {
+				vector<Promotion> promotions;
+				SparseBitVector<> escaping;
+				bool solved = false;
+				for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+					CallBase *call = dyn_cast<CallBase>(&*I);
+					Promotion promotion = {call, call == nullptr ? 0 : allocationSize(call), {}};
+					if (promotion.Size == 0 || promotion.Size > StackLimit || isInCycle(call->getParent()))
+						continue;
+					const SparseBitVector<> &objects = Solver.pointsTo(call);
+					assert(objects.count() == 1 && "an allocation points to its memory");
+					unsigned object = objects.find_first();
+					if (!solved) {
+						escaping = escapingObjects(F);
+						solved = true;
+					}
+					if (escaping.test(object) || Hidden.test(object) || !findFrees(F, object, promotion.Frees))
+						continue;
+					promotions.push_back(promotion);
 				}
+				return promotions;
+			}
 
-				for (int i = 0; i < Infos.size(); ++i)
-					Info::join(Infos[i], temp, Infos[i]);
-				delete temp;
-			}	
+		private:
+			AndersenSolver Solver;
+			// the deallocations of the module, the memory the other library calls may hide
+			vector<CallBase *> Frees;
+			SparseBitVector<> Hidden;
+
+			// the constant size of the memory of an allocation call the pass knows, 0 for the others
+			static uint64_t allocationSize(CallBase *call) {
+				Function *callee = call->getCalledFunction();
+				if (callee == nullptr || !callee->isDeclaration() || classifyCall(call) != Allocation)
+					return 0;
+				StringRef name = callee->getName();
+				unsigned sizes = StringSwitch<unsigned>(name)
+					.Cases("malloc", "_Znwm", "_Znam", "_ZnwmRKSt9nothrow_t", "_ZnamRKSt9nothrow_t", 1)
+					.Case("calloc", 2)
+					.Default(0);
+				uint64_t size = 1;
+				for (unsigned k = 0; k < sizes; ++k) {
+					ConstantInt *c = dyn_cast<ConstantInt>(call->getArgOperand(k));
+					// the limit keeps the product of calloc from overflowing
+					if (c == nullptr || c->getValue().ugt(StackLimit))
+						return 0;
+					size *= c->getZExtValue();
+				}
+				return sizes == 0 ? 0 : size;
+			}
+
+			static bool isDeallocation(CallBase *call) {
+				Function *callee = call->getCalledFunction();
+				if (callee == nullptr || !callee->isDeclaration())
+					return false;
+				return StringSwitch<bool>(callee->getName())
+					.Cases("free", "_ZdlPv", "_ZdaPv", "_ZdlPvm", "_ZdaPvm", true)
+					.Default(false);
+			}
+
+			// true if BB may run more than once in a call of its function
+			static bool isInCycle(BasicBlock *BB) {
+				vector<BasicBlock *> worklist(succ_begin(BB), succ_end(BB));
+				set<BasicBlock *> visited;
+				while (!worklist.empty()) {
+					BasicBlock *block = worklist.back();
+					worklist.pop_back();
+					if (block == BB)
+						return true;
+					if (visited.insert(block).second)
+						worklist.insert(worklist.end(), succ_begin(block), succ_end(block));
+				}
+				return false;
+			}
+
+			// the memory reachable from the memory that outlives a call of F and from its arguments
+			// and returned values
+			SparseBitVector<> escapingObjects(Function &F) {
+				SparseBitVector<> roots = Solver.objectsOutside(&F);
+				for (Argument &arg : F.args()) {
+					if (arg.getType()->isPointerTy())
+						roots |= Solver.pointsTo(&arg);
+				}
+				for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+					ReturnInst *ret = dyn_cast<ReturnInst>(&*I);
+					if (ret != nullptr && ret->getReturnValue() != nullptr && ret->getReturnValue()->getType()->isPointerTy())
+						roots |= Solver.pointsTo(ret->getReturnValue());
+				}
+				return Solver.reachable(roots);
+			}
+
+			// the frees of object in F, false if a free elsewhere or of other memory may free it
+			bool findFrees(Function &F, unsigned object, vector<CallBase *> &frees) {
+				for (CallBase *call : Frees) {
+					const SparseBitVector<> &objects = Solver.pointsTo(call->getArgOperand(0));
+					if (!objects.test(object))
+						continue;
+					if (call->getFunction() != &F || objects.count() != 1)
+						return false;
+					frees.push_back(call);
+				}
+				return true;
+			}
 	};
 
 	/*
@@ -225,16 +1729,270 @@ namespace {
 
 		MayPointToAnalysisPass() : FunctionPass(ID) {}
 
-		bool runOnFunction(Function &F) override {
-			MayPointToInfo bottom;
-			MayPointToAnalysis <MayPointToInfo, true> mpa(bottom, bottom);
+		template<class Info>
+		void runOn(Function &F) {
+			Info bottom;
+			MayPointToAnalysis <Info, true> mpa(bottom, bottom);
 			mpa.runWorklistAlgorithm(&F);
 			mpa.print();
+			if (DFAOptions::PrintStats)
+				mpa.printStatistics();
+			mpa.reportStatistics(&F);
+		}
+
+		bool runOnFunction(Function &F) override {
+			if (UseBDD)
+				runOn<MayPointToBDDInfo>(F);
+			else
+				runOn<MayPointToInfo>(F);
+			return false;
+		}
+
+		bool doFinalization(Module &M) override {
+			DFAReport::printSlowest();
+			if (UseBDD && DFAOptions::PrintStats)
+				BDD::get().printStatistics();
+			return false;
+		}
+
+	};
+
+	/*
+	 * a module pass do the may-point-to analysis on all the functions in parallel
+	 */
+	struct MayPointToAnalysisModulePass : public ModulePass {
+		static char ID;
+
+		MayPointToAnalysisModulePass() : ModulePass(ID) {}
+
+		template<class Info>
+		void runOn(Module &M) {
+			Info bottom;
+			runOnModuleParallel<MayPointToAnalysis<Info, true>>(M, bottom, bottom,
+				&MayPointToAnalysis<Info, true>::runWorklistAlgorithm);
+		}
+
+		bool runOnModule(Module &M) override {
+			if (UseBDD)
+				runOn<MayPointToBDDInfo>(M);
+			else
+				runOn<MayPointToInfo>(M);
+			return false;
+		}
+
+	};
+
+	/*
+	 * a module pass do the may-point-to analysis bottom-up on the call graph,
+	 * applying the summaries of the callees at the call sites
+	 */
+	struct MayPointToAnalysisInterproceduralPass : public ModulePass {
+		static char ID;
+
+		MayPointToAnalysisInterproceduralPass() : ModulePass(ID) {}
+
+		template<class Info>
+		void runOn(Module &M) {
+			Info bottom;
+			runInterprocedural<MayPointToAnalysis<Info, true>>(M, bottom, bottom,
+				&MayPointToAnalysis<Info, true>::runWorklistAlgorithm);
+		}
+
+		bool runOnModule(Module &M) override {
+			if (UseBDD)
+				runOn<MayPointToBDDInfo>(M);
+			else
+				runOn<MayPointToInfo>(M);
+			return false;
+		}
+
+	};
+
+	/*
+	 * a module pass run the may-point-to analysis on synthetic functions of growing size,
+	 * the input module is ignored
+	 */
+	struct MayPointToAnalysisBenchmarkPass : public ModulePass {
+		static char ID;
+
+		MayPointToAnalysisBenchmarkPass() : ModulePass(ID) {}
+
+		bool runOnModule(Module &M) override {
+			if (UseBDD) {
+				MayPointToBDDInfo bottom;
+				runBenchmark<MayPointToAnalysis<MayPointToBDDInfo, true>>(M.getContext(), "cse231-maypointto-bdd", bottom, bottom,
+					&MayPointToAnalysis<MayPointToBDDInfo, true>::runWorklistAlgorithm);
+			} else {
+				MayPointToInfo bottom;
+				runBenchmark<MayPointToAnalysis<MayPointToInfo, true>>(M.getContext(), "cse231-maypointto", bottom, bottom,
+					&MayPointToAnalysis<MayPointToInfo, true>::runWorklistAlgorithm);
+			}
+			return false;
+		}
+
+	};
+
+	/*
+	 * a module pass check the incremental re-solve of the may-point-to analysis after
+	 * random edits against solving from scratch, the input module is not changed
+	 */
+	struct MayPointToIncrementalCheckPass : public ModulePass {
+		static char ID;
+
+		MayPointToIncrementalCheckPass() : ModulePass(ID) {}
+
+		bool runOnModule(Module &M) override {
+			if (UseBDD) {
+				MayPointToBDDInfo bottom;
+				runIncrementalCheck<MayPointToAnalysis<MayPointToBDDInfo, true>>(M, "cse231-maypointto-bdd", bottom, bottom);
+			} else {
+				MayPointToInfo bottom;
+				runIncrementalCheck<MayPointToAnalysis<MayPointToInfo, true>>(M, "cse231-maypointto", bottom, bottom);
+			}
+			return false;
+		}
+
+	};
+
+	/*
+	 * a module pass do the flow-insensitive Andersen may-point-to analysis on the whole module
+	 */
+	struct MayPointToAndersenPass : public ModulePass {
+		static char ID;
+
+		MayPointToAndersenPass() : ModulePass(ID) {}
+
+		bool runOnModule(Module &M) override {
+			AndersenSolver solver;
+			solver.build(M);
+			solver.solve();
+			solver.print(M);
+			if (DFAOptions::PrintStats)
+				solver.printStatistics(M);
+			return false;
+		}
+
+	};
+
+	/*
+	 * a module pass do the flow-insensitive Steensgaard may-point-to analysis on the whole module,
+	 * a cheap first pass to find the functions that need the flow-sensitive one
+	 */
+	struct MayPointToSteensgaardPass : public ModulePass {
+		static char ID;
+
+		MayPointToSteensgaardPass() : ModulePass(ID) {}
+
+		bool runOnModule(Module &M) override {
+			SteensgaardSolver solver;
+			solver.build(M);
+			solver.solve();
+			solver.print(M);
+			if (DFAOptions::PrintStats)
+				solver.printStatistics(M);
+			return false;
+		}
+
+	};
+
+	/*
+	 * a module pass move the heap allocations found by EscapeAnalysis to the stack:
+	 *   %p = call i8* @malloc(i64 16) ... call void @free(i8* %p)
+	 * becomes an alloca of [16 x i8] in the entry block, and the frees are removed.
+	 * calloc zeroes its memory with a memset where it was called
+	 */
+	struct HeapToStackPass : public ModulePass {
+		static char ID;
+
+		HeapToStackPass() : ModulePass(ID) {}
+
+		bool runOnModule(Module &M) override {
+			EscapeAnalysis escapes(M);
+			vector<EscapeAnalysis::Promotion> promotions;
+			unsigned allocations = 0;
+			for (Function &F : M) {
+				for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+					if (isa<CallBase>(&*I) && classifyCall(&*I) == Allocation)
+						++allocations;
+				}
+				vector<EscapeAnalysis::Promotion> found = escapes.findPromotions(F);
+				promotions.insert(promotions.end(), found.begin(), found.end());
+			}
+
+			unsigned frees = 0;
+			for (EscapeAnalysis::Promotion &promotion : promotions) {
+				promote(promotion, M.getDataLayout());
+				frees += promotion.Frees.size();
+			}
+			if (DFAOptions::PrintStats)
+				errs() << "Heap to stack: " << promotions.size() << "/" << allocations << " allocations, "
+					<< frees << " frees removed\n";
+			return !promotions.empty();
+		}
+
+		static void promote(EscapeAnalysis::Promotion &promotion, const DataLayout &DL) {
+			CallBase *call = promotion.Allocation;
+			LLVMContext &C = call->getContext();
+			BasicBlock &entry = call->getFunction()->getEntryBlock();
+			Type *type = ArrayType::get(Type::getInt8Ty(C), promotion.Size);
+			AllocaInst *slot = new AllocaInst(type, DL.getAllocaAddrSpace(), nullptr, Align(16),
+				call->getName() + ".stack", &*entry.getFirstInsertionPt());
+			// new may throw, the alloca does not
+			if (InvokeInst *invoke = dyn_cast<InvokeInst>(call))
+				call = changeToCall(invoke);
+			Value *memory = CastInst::CreatePointerBitCastOrAddrSpaceCast(slot, call->getType(), "", call);
+			if (call->getCalledFunction()->getName() == "calloc")
+				IRBuilder<>(call).CreateMemSet(memory, ConstantInt::get(Type::getInt8Ty(C), 0), promotion.Size, Align(16));
+			memory->takeName(call);
+			call->replaceAllUsesWith(memory);
+			call->eraseFromParent();
+			for (CallBase *free : promotion.Frees) {
+				if (InvokeInst *invoke = dyn_cast<InvokeInst>(free))
+					free = changeToCall(invoke);
+				free->eraseFromParent();
+			}
+		}
+	};
+
+	/*
+	 * an immutable pass that add MayPointToAAResult to the alias analyses of the functions, e.g.
+	 *   opt -load MayPointToAnalysis.so -cse231-maypointto-aa -gvn -licm
+	 * the points-to sets are solved once for the module, the first time they are needed
+	 */
+	struct MayPointToExternalAA : public ExternalAAWrapperPass {
+		static char ID;
+
+		MayPointToExternalAA() : ExternalAAWrapperPass([this](Pass &P, Function &F, AAResults &AAR) {
+				if (Result == nullptr)
+					Result.reset(new MayPointToAAResult(*F.getParent()));
+				AAR.addAAResult(*Result);
+			}) {}
+
+		bool doFinalization(Module &M) override {
+			if (Result != nullptr && DFAOptions::PrintStats)
+				Result->printStatistics();
 			return false;
 		}
 
+		unique_ptr<MayPointToAAResult> Result;
 	};
 };
 
 char MayPointToAnalysisPass::ID = 0;
+char MayPointToAnalysisModulePass::ID = 0;
+char MayPointToAnalysisInterproceduralPass::ID = 0;
+char MayPointToAnalysisBenchmarkPass::ID = 0;
+char MayPointToAndersenPass::ID = 0;
+char MayPointToSteensgaardPass::ID = 0;
+char MayPointToExternalAA::ID = 0;
+char HeapToStackPass::ID = 0;
+char MayPointToIncrementalCheckPass::ID = 0;
 static RegisterPass<MayPointToAnalysisPass> X("cse231-maypointto", false, false);
+static RegisterPass<MayPointToAnalysisModulePass> Y("cse231-maypointto-parallel", false, false);
+static RegisterPass<MayPointToAnalysisInterproceduralPass> Z("cse231-maypointto-interprocedural", false, false);
+static RegisterPass<MayPointToAnalysisBenchmarkPass> W("cse231-maypointto-benchmark", false, false);
+static RegisterPass<MayPointToAndersenPass> V("cse231-maypointto-andersen", false, false);
+static RegisterPass<MayPointToSteensgaardPass> U("cse231-maypointto-steensgaard", false, false);
+static RegisterPass<MayPointToExternalAA> T("cse231-maypointto-aa", "May-point-to alias analysis", false, true);
+static RegisterPass<HeapToStackPass> S("cse231-heap2stack", false, false);
+static RegisterPass<MayPointToIncrementalCheckPass> R("cse231-maypointto-incremental-check", false, false);
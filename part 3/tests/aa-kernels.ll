@@ -0,0 +1,159 @@
+; LOAD: MayPointToAnalysis.so
+; RUN: -cse231-maypointto-aa -basic-aa -licm -gvn -dse
+; STATS: Alias queries: 24, no alias: 24, call queries: 10, no mod/ref: 4
+;
+; pointer-heavy kernels for bench-aa.sh. the arrays and the cells are separate mallocs,
+; but the kernels get them as arguments, so -basic-aa cannot tell them apart. with the
+; may-point-to alias analysis, -licm hoists the loads of %k and %off out of @scale and
+; keeps *%acc of @dot and y[i] of @matvec in registers
+
+@fmt = private constant [10 x i8] c"%d %d %d\0A\00"
+declare i32 @printf(i8*, ...)
+declare i8* @malloc(i64)
+declare i32 @atoi(i8*)
+
+; a[i] = a[i] * *k + *off
+define internal void @scale(i32* %a, i32* %k, i32* %off, i64 %n) {
+entry:
+  br label %loop
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i1, %loop ]
+  %kv = load i32, i32* %k
+  %ov = load i32, i32* %off
+  %pa = getelementptr i32, i32* %a, i64 %i
+  %x = load i32, i32* %pa
+  %m = mul i32 %x, %kv
+  %s = add i32 %m, %ov
+  store i32 %s, i32* %pa
+  %i1 = add i64 %i, 1
+  %c = icmp slt i64 %i1, %n
+  br i1 %c, label %loop, label %exit
+exit:
+  ret void
+}
+
+; *acc += a[i] * b[i]
+define internal void @dot(i32* %a, i32* %b, i32* %acc, i64 %n) {
+entry:
+  br label %loop
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i1, %loop ]
+  %pa = getelementptr i32, i32* %a, i64 %i
+  %pb = getelementptr i32, i32* %b, i64 %i
+  %x = load i32, i32* %pa
+  %y = load i32, i32* %pb
+  %p = mul i32 %x, %y
+  %v = load i32, i32* %acc
+  %v1 = add i32 %v, %p
+  store i32 %v1, i32* %acc
+  %i1 = add i64 %i, 1
+  %c = icmp slt i64 %i1, %n
+  br i1 %c, label %loop, label %exit
+exit:
+  ret void
+}
+
+; y[i] += m[i * n + j] * x[j]
+define internal void @matvec(i32* %m, i32* %x, i32* %y, i64 %n) {
+entry:
+  br label %outer
+outer:
+  %i = phi i64 [ 0, %entry ], [ %i1, %next ]
+  %py = getelementptr i32, i32* %y, i64 %i
+  %row = mul i64 %i, %n
+  br label %inner
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j1, %inner ]
+  %r = add i64 %row, %j
+  %pm = getelementptr i32, i32* %m, i64 %r
+  %px = getelementptr i32, i32* %x, i64 %j
+  %mv = load i32, i32* %pm
+  %xv = load i32, i32* %px
+  %p = mul i32 %mv, %xv
+  %yv = load i32, i32* %py
+  %yv1 = add i32 %yv, %p
+  store i32 %yv1, i32* %py
+  %j1 = add i64 %j, 1
+  %cj = icmp slt i64 %j1, %n
+  br i1 %cj, label %inner, label %next
+next:
+  %i1 = add i64 %i, 1
+  %ci = icmp slt i64 %i1, %n
+  br i1 %ci, label %outer, label %exit
+exit:
+  ret void
+}
+
+; p[i] = (i * mul) & 15
+define internal void @fill(i32* %p, i64 %n, i32 %mul) {
+entry:
+  br label %loop
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i1, %loop ]
+  %t = trunc i64 %i to i32
+  %v = mul i32 %t, %mul
+  %w = and i32 %v, 15
+  %pi = getelementptr i32, i32* %p, i64 %i
+  store i32 %w, i32* %pi
+  %i1 = add i64 %i, 1
+  %c = icmp slt i64 %i1, %n
+  br i1 %c, label %loop, label %exit
+exit:
+  ret void
+}
+
+; runs the kernels 1000 times, or as many as the first argument says
+define i32 @main(i32 %argc, i8** %argv) {
+entry:
+  %has = icmp sgt i32 %argc, 1
+  br i1 %has, label %arg, label %start
+arg:
+  %parg = getelementptr i8*, i8** %argv, i64 1
+  %sarg = load i8*, i8** %parg
+  %narg = call i32 @atoi(i8* %sarg)
+  br label %start
+start:
+  %reps = phi i32 [ 1000, %entry ], [ %narg, %arg ]
+  %ma = call i8* @malloc(i64 1024)
+  %mb = call i8* @malloc(i64 1024)
+  %mk = call i8* @malloc(i64 4)
+  %moff = call i8* @malloc(i64 4)
+  %macc = call i8* @malloc(i64 4)
+  %mm = call i8* @malloc(i64 262144)
+  %mx = call i8* @malloc(i64 1024)
+  %my = call i8* @malloc(i64 1024)
+  %a = bitcast i8* %ma to i32*
+  %b = bitcast i8* %mb to i32*
+  %k = bitcast i8* %mk to i32*
+  %off = bitcast i8* %moff to i32*
+  %acc = bitcast i8* %macc to i32*
+  %m = bitcast i8* %mm to i32*
+  %x = bitcast i8* %mx to i32*
+  %y = bitcast i8* %my to i32*
+  call void @fill(i32* %a, i64 256, i32 1)
+  call void @fill(i32* %b, i64 256, i32 3)
+  call void @fill(i32* %m, i64 65536, i32 5)
+  call void @fill(i32* %x, i64 256, i32 7)
+  call void @fill(i32* %y, i64 256, i32 0)
+  store i32 3, i32* %k
+  store i32 1, i32* %off
+  store i32 0, i32* %acc
+  br label %rep
+rep:
+  %r = phi i32 [ 0, %start ], [ %r1, %rep ]
+  call void @scale(i32* %a, i32* %k, i32* %off, i64 256)
+  call void @dot(i32* %a, i32* %b, i32* %acc, i64 256)
+  call void @matvec(i32* %m, i32* %x, i32* %y, i64 256)
+  %r1 = add i32 %r, 1
+  %c = icmp slt i32 %r1, %reps
+  br i1 %c, label %rep, label %done
+done:
+  %av = load i32, i32* %acc
+  %py = getelementptr i32, i32* %y, i64 5
+  %yv = load i32, i32* %py
+  %pa = getelementptr i32, i32* %a, i64 7
+  %aval = load i32, i32* %pa
+  %f = getelementptr [10 x i8], [10 x i8]* @fmt, i32 0, i32 0
+  call i32 (i8*, ...) @printf(i8* %f, i32 %av, i32 %yv, i32 %aval)
+  ret i32 0
+}
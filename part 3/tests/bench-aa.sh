@@ -0,0 +1,64 @@
+#!/bin/bash
+# bench-aa.sh <directory of the built passes> [repetitions] [runs]
+#
+# optimizes aa-kernels.ll with -basic-aa -licm -gvn -dse, once alone and once after
+# -cse231-maypointto-aa, and compiles both with llc and cc. for each function it prints
+# the loads and stores left in its loops by loop depth. then it runs both binaries with
+# the kernels repeated repetitions times (default 20000), checks that they print the same,
+# and prints the fastest user time of runs (default 5) runs of each.
+
+passes=$1
+repetitions=${2:-20000}
+runs=${3:-5}
+program="$(dirname "$0")/aa-kernels.ll"
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+build() {
+	opt -enable-new-pm=0 "${@:2}" -basic-aa -licm -gvn -dse "$program" -o "$work/$1.bc" &&
+		llc -O2 -relocation-model=pic -filetype=obj "$work/$1.bc" -o "$work/$1.o" &&
+		cc "$work/$1.o" -o "$work/$1" || { echo "FAIL $1: build"; exit 1; }
+}
+build basic
+build maypointto -load "$passes/MayPointToAnalysis.so" -cse231-maypointto-aa
+
+# loop depth of each block from the loop info, then the loads and stores per function and depth
+count() {
+	awk '
+		FNR == NR && /^Printing analysis/ { fn = $NF; gsub(/[\047:]/, "", fn) }
+		FNR == NR && /Loop at depth/ {
+			list = $NF
+			gsub(/<[a-z]+>/, "", list)
+			n = split(list, blocks, ",")
+			for (i = 1; i <= n; ++i) {
+				b = substr(blocks[i], 2)
+				if ($4 > depth[fn, b])
+					depth[fn, b] = $4
+			}
+		}
+		FNR == NR { next }
+		/^define/ { fn = $0; sub(/\(.*/, "", fn); sub(/.*@/, "", fn); order[++fns] = fn }
+		/^[A-Za-z0-9_.]+:/ { block = $1; sub(/:$/, "", block) }
+		/ = load / { d = depth[fn, block]; if (d) { loads[fn, d]++; if (d > max[fn]) max[fn] = d } }
+		/^  store / { d = depth[fn, block]; if (d) { stores[fn, d]++; if (d > max[fn]) max[fn] = d } }
+		END {
+			for (f = 1; f <= fns; ++f)
+				for (d = 1; d <= max[order[f]]; ++d)
+					printf "%-10s %-8s depth %d: %d loads, %d stores\n", "'"$1"'", order[f], d,
+						loads[order[f], d], stores[order[f], d]
+		}
+	' <(opt -enable-new-pm=0 -analyze -loops "$work/$1.bc") <(llvm-dis "$work/$1.bc" -o -)
+}
+count basic
+count maypointto
+
+[ "$("$work/basic" $repetitions)" == "$("$work/maypointto" $repetitions)" ] || { echo "FAIL: output"; exit 1; }
+TIMEFORMAT=%U
+for binary in basic maypointto; do
+	best=
+	for ((i = 0; i < runs; ++i)); do
+		t=$( { time "$work/$binary" $repetitions > /dev/null; } 2>&1 )
+		[ -z "$best" ] || awk "BEGIN { exit !($t < $best) }" && best=$t
+	done
+	echo "$binary: ${best}s"
+done
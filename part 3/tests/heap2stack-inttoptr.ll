@@ -0,0 +1,43 @@
+; LOAD: MayPointToAnalysis.so
+; RUN: -cse231-heap2stack
+; STATS: Heap to stack: 0/1 allocations, 0 frees removed
+;
+; the pointer returned by malloc is read back from memory as an integer and
+; stored to a global as a pointer again: the allocation escapes, and moving it
+; to the stack would leave @G pointing into the dead frame of leak
+
+@G = global i8* null
+
+declare i8* @malloc(i64)
+declare i32 @puts(i8*)
+
+define void @leak() {
+  %slot = alloca i8*
+  %m = call i8* @malloc(i64 8)
+  store i8 104, i8* %m
+  %h = getelementptr i8, i8* %m, i64 1
+  store i8 0, i8* %h
+  store i8* %m, i8** %slot
+  %islot = bitcast i8** %slot to i64*
+  %i = load i64, i64* %islot
+  %p = inttoptr i64 %i to i8*
+  store i8* %p, i8** @G
+  ret void
+}
+
+define void @clobber() {
+  %buf = alloca [64 x i8]
+  %b = getelementptr [64 x i8], [64 x i8]* %buf, i64 0, i64 0
+  call void @llvm.memset.p0i8.i64(i8* %b, i8 0, i64 64, i1 true)
+  ret void
+}
+
+declare void @llvm.memset.p0i8.i64(i8*, i8, i64, i1)
+
+define i32 @main() {
+  call void @leak()
+  call void @clobber()
+  %g = load i8*, i8** @G
+  %r = call i32 @puts(i8* %g)
+  ret i32 0
+}
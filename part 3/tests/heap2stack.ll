@@ -0,0 +1,226 @@
+; LOAD: MayPointToAnalysis.so
+; RUN: -cse231-heap2stack
+; STATS: Heap to stack: 4/11 allocations, 4 frees removed
+;
+; promoted: the buffers of local, zeroed and invoked, and the first node of chain.
+; kept on the heap: the second node of chain (sum reads the node as integers, so what
+; it holds escapes), the memory of ret (returned), toglobal (stored to a global),
+; loop (allocated in a cycle), big (too big), printed (passed to printf) and
+; freedelsewhere (freed by a callee)
+
+%node = type { i32, %node* }
+@global = global %node* null
+@fmt = private constant [22 x i8] c"%d %d %d %d %d %d %d\0A\00"
+@fmt2 = private constant [4 x i8] c"%s\0A\00"
+@hi = private constant [3 x i8] c"hi\00"
+declare i8* @malloc(i64)
+declare i8* @calloc(i64, i64)
+declare void @free(i8*)
+declare i8* @_Znwm(i64)
+declare void @_ZdlPv(i8*)
+declare i32 @printf(i8*, ...)
+declare i8* @strcpy(i8*, i8*)
+declare i32 @__gxx_personality_v0(...)
+
+
+define i32 @sum(%node* %n0) {
+entry:
+  br label %loop
+loop:
+  %n = phi %node* [ %n0, %entry ], [ %next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s2, %body ]
+  %c = icmp eq %node* %n, null
+  br i1 %c, label %done, label %body
+body:
+  %vp = getelementptr %node, %node* %n, i32 0, i32 0
+  %v = load i32, i32* %vp
+  %s2 = add i32 %s, %v
+  %np = getelementptr %node, %node* %n, i32 0, i32 1
+  %next = load %node*, %node** %np
+  br label %loop
+done:
+  ret i32 %s
+}
+
+; promotable
+define i32 @local(i32 %x) {
+entry:
+  %m = call i8* @malloc(i64 64)
+  %a = bitcast i8* %m to i32*
+  br label %fill
+fill:
+  %i = phi i32 [ 0, %entry ], [ %i2, %fill ]
+  %s = phi i32 [ 0, %entry ], [ %s2, %fill ]
+  %p = getelementptr i32, i32* %a, i32 %i
+  %v = mul i32 %i, %x
+  store i32 %v, i32* %p
+  %r = load i32, i32* %p
+  %s2 = add i32 %s, %r
+  %i2 = add i32 %i, 1
+  %c = icmp slt i32 %i2, 16
+  br i1 %c, label %fill, label %out
+out:
+  call void @free(i8* %m)
+  ret i32 %s2
+}
+
+; promotable calloc, zeroed
+define i32 @zeroed() {
+  %m = call i8* @calloc(i64 8, i64 4)
+  %a = bitcast i8* %m to i32*
+  %p3 = getelementptr i32, i32* %a, i32 3
+  store i32 5, i32* %p3
+  %v0 = load i32, i32* %a
+  %v3 = load i32, i32* %p3
+  %p7 = getelementptr i32, i32* %a, i32 7
+  %v7 = load i32, i32* %p7
+  %s1 = add i32 %v0, %v3
+  %s = add i32 %s1, %v7
+  call void @free(i8* %m)
+  ret i32 %s
+}
+
+; escapes: returned
+define i32* @ret() {
+  %m = call i8* @malloc(i64 8)
+  %p = bitcast i8* %m to i32*
+  store i32 42, i32* %p
+  ret i32* %p
+}
+
+; escapes: stored to a global
+define void @toglobal() {
+  %m = call i8* @malloc(i64 16)
+  %n = bitcast i8* %m to %node*
+  %vp = getelementptr %node, %node* %n, i32 0, i32 0
+  store i32 7, i32* %vp
+  %np = getelementptr %node, %node* %n, i32 0, i32 1
+  store %node* null, %node** %np
+  store %node* %n, %node** @global
+  ret void
+}
+
+; both promotable, passed to sum which does not keep them
+define i32 @chain() {
+  %ma = call i8* @malloc(i64 16)
+  %mb = call i8* @_Znwm(i64 16)
+  %a = bitcast i8* %ma to %node*
+  %b = bitcast i8* %mb to %node*
+  %av = getelementptr %node, %node* %a, i32 0, i32 0
+  store i32 1, i32* %av
+  %an = getelementptr %node, %node* %a, i32 0, i32 1
+  store %node* %b, %node** %an
+  %bv = getelementptr %node, %node* %b, i32 0, i32 0
+  store i32 2, i32* %bv
+  %bn = getelementptr %node, %node* %b, i32 0, i32 1
+  store %node* null, %node** %bn
+  %s = call i32 @sum(%node* %a)
+  call void @_ZdlPv(i8* %mb)
+  call void @free(i8* %ma)
+  ret i32 %s
+}
+
+; in a loop: not promoted
+define i32 @loop(i32 %n) {
+entry:
+  br label %head
+head:
+  %i = phi i32 [ 0, %entry ], [ %i2, %body ]
+  %list = phi %node* [ null, %entry ], [ %c, %body ]
+  %cc = icmp slt i32 %i, %n
+  br i1 %cc, label %body, label %done
+body:
+  %m = call i8* @malloc(i64 16)
+  %c = bitcast i8* %m to %node*
+  %vp = getelementptr %node, %node* %c, i32 0, i32 0
+  store i32 %i, i32* %vp
+  %np = getelementptr %node, %node* %c, i32 0, i32 1
+  store %node* %list, %node** %np
+  %i2 = add i32 %i, 1
+  br label %head
+done:
+  %s = call i32 @sum(%node* %list)
+  ret i32 %s
+}
+
+; too big
+define i32 @big() {
+  %p = call i8* @malloc(i64 1048576)
+  %q = getelementptr i8, i8* %p, i32 5
+  store i8 1, i8* %q
+  %r = load i8, i8* %q
+  call void @free(i8* %p)
+  %z = zext i8 %r to i32
+  ret i32 %z
+}
+
+; escapes to printf and strcpy
+define i32 @printed() {
+  %p = call i8* @malloc(i64 32)
+  %h = getelementptr [3 x i8], [3 x i8]* @hi, i32 0, i32 0
+  %x = call i8* @strcpy(i8* %p, i8* %h)
+  %f = getelementptr [4 x i8], [4 x i8]* @fmt2, i32 0, i32 0
+  %y = call i32 (i8*, ...) @printf(i8* %f, i8* %p)
+  call void @free(i8* %p)
+  ret i32 0
+}
+
+define void @freeit(i32* %p) {
+  %m = bitcast i32* %p to i8*
+  call void @free(i8* %m)
+  ret void
+}
+
+; freed in a callee: not promoted
+define i32 @freedelsewhere() {
+  %m = call i8* @malloc(i64 4)
+  %p = bitcast i8* %m to i32*
+  store i32 3, i32* %p
+  %r = load i32, i32* %p
+  call void @freeit(i32* %p)
+  ret i32 %r
+}
+
+; invoke of new: promotable
+define i32 @invoked() personality i8* bitcast (i32 (...)* @__gxx_personality_v0 to i8*) {
+entry:
+  %m = invoke i8* @_Znwm(i64 4) to label %ok unwind label %lp
+ok:
+  %p = bitcast i8* %m to i32*
+  store i32 9, i32* %p
+  invoke void @may_throw() to label %ok2 unwind label %lp
+ok2:
+  %r = load i32, i32* %p
+  call void @_ZdlPv(i8* %m)
+  ret i32 %r
+lp:
+  %l = landingpad { i8*, i32 } cleanup
+  resume { i8*, i32 } %l
+}
+
+define void @may_throw() {
+  ret void
+}
+
+define i32 @main() {
+  %r = call i32* @ret()
+  %rv = load i32, i32* %r
+  call void @toglobal()
+  %g = load %node*, %node** @global
+  %gvp = getelementptr %node, %node* %g, i32 0, i32 0
+  %gv = load i32, i32* %gvp
+  %a = call i32 @local(i32 3)
+  %b = call i32 @zeroed()
+  %c = call i32 @chain()
+  %d = call i32 @loop(i32 10)
+  %e = call i32 @big()
+  %f = call i32 @printed()
+  %h = call i32 @freedelsewhere()
+  %i = call i32 @invoked()
+  %s1 = add i32 %a, %b
+  %s2 = add i32 %e, %f
+  %s3 = add i32 %h, %i
+  %fmt = getelementptr [22 x i8], [22 x i8]* @fmt, i32 0, i32 0
+  %x = call i32 (i8*, ...) @printf(i8* %fmt, i32 %s1, i32 %rv, i32 %gv, i32 %c, i32 %d, i32 %s2, i32 %s3)
+  ret i32 0
+}
@@ -0,0 +1,66 @@
+; LOAD: LivenessAnalysis.so MayPointToAnalysis.so
+; RUN: -cse231-liveness-incremental-check -cse231-maypointto-incremental-check -cse231-dfa-check-rounds=10
+; STATS: Incremental check: cse231-liveness, 7 functions, 70 rounds, 6 of them structural, 0 mismatches
+; STATS: Incremental check: cse231-maypointto, 7 functions, 70 rounds, 6 of them structural, 0 mismatches
+;
+; the incremental re-solve after random operand and branch edits of @walk, @main and the
+; synthetic functions must give the facts of solving from scratch. the checks edit a copy,
+; so the program itself does not change
+
+@fmt = private constant [7 x i8] c"%d %d\0A\00"
+declare i32 @printf(i8*, ...)
+
+define i32 @walk(i32* %a, i32* %b, i32 %n) {
+entry:
+  %slot = alloca i32*
+  %sum = alloca i32
+  store i32 0, i32* %sum
+  store i32* %a, i32** %slot
+  br label %loop
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i2, %latch ]
+  %p = load i32*, i32** %slot
+  %q = getelementptr i32, i32* %p, i32 %i
+  %v = load i32, i32* %q
+  %odd = and i32 %i, 1
+  %c = icmp eq i32 %odd, 0
+  br i1 %c, label %even, label %latch
+even:
+  %s = load i32, i32* %sum
+  %s2 = add i32 %s, %v
+  store i32 %s2, i32* %sum
+  store i32* %b, i32** %slot
+  br label %latch
+latch:
+  %i2 = add i32 %i, 1
+  %more = icmp slt i32 %i2, %n
+  br i1 %more, label %loop, label %out
+out:
+  %r = load i32, i32* %sum
+  ret i32 %r
+}
+
+define i32 @main() {
+entry:
+  %a = alloca [4 x i32]
+  %b = alloca [4 x i32]
+  %a0 = getelementptr [4 x i32], [4 x i32]* %a, i32 0, i32 0
+  %b0 = getelementptr [4 x i32], [4 x i32]* %b, i32 0, i32 0
+  br label %fill
+fill:
+  %i = phi i32 [ 0, %entry ], [ %i2, %fill ]
+  %pa = getelementptr i32, i32* %a0, i32 %i
+  %pb = getelementptr i32, i32* %b0, i32 %i
+  store i32 %i, i32* %pa
+  %ten = mul i32 %i, 10
+  store i32 %ten, i32* %pb
+  %i2 = add i32 %i, 1
+  %c = icmp slt i32 %i2, 4
+  br i1 %c, label %fill, label %done
+done:
+  %r1 = call i32 @walk(i32* %a0, i32* %b0, i32 4)
+  %r2 = call i32 @walk(i32* %b0, i32* %a0, i32 3)
+  %f = getelementptr [7 x i8], [7 x i8]* @fmt, i32 0, i32 0
+  call i32 (i8*, ...) @printf(i8* %f, i32 %r1, i32 %r2)
+  ret i32 0
+}
@@ -0,0 +1,74 @@
+; LOAD: LivenessAnalysis.so
+; RUN: -cse231-liveness-dce
+; STATS: Dead code: 14 instructions removed, 3 of them stores, 8 liveness rounds
+;
+; removed: the arithmetic only stored to %buf, the stores to %buf and %t that nothing
+; reads, the dead load of %t, the division by zero of main, and the phi and multiplication
+; of cycle, which only use each other (-dce keeps them). kept: the stores to %kept, which
+; @use reads
+
+@fmt = private constant [10 x i8] c"%d %d %d\0A\00"
+declare i32 @printf(i8*, ...)
+
+
+define i32 @f(i32 %n) {
+entry:
+  %buf = alloca [8 x i32]
+  %t = alloca i32
+  %kept = alloca i32
+  %dead1 = mul i32 %n, 7
+  %dead2 = add i32 %dead1, 3
+  %p0 = getelementptr [8 x i32], [8 x i32]* %buf, i32 0, i32 0
+  store i32 %dead2, i32* %p0
+  store i32 5, i32* %t
+  %unused = load i32, i32* %t
+  store i32 %n, i32* %kept
+  call void @use(i32* %kept)
+  br label %loop
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i2, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s2, %loop ]
+  %x = mul i32 %i, %i
+  %xd = sdiv i32 %x, 3
+  %pi = getelementptr [8 x i32], [8 x i32]* %buf, i32 0, i32 %i
+  store i32 %x, i32* %pi
+  %s2 = add i32 %s, %x
+  %i2 = add i32 %i, 1
+  %c = icmp slt i32 %i2, 8
+  br i1 %c, label %loop, label %out
+out:
+  %k = load i32, i32* %kept
+  %r = add i32 %s2, %k
+  ret i32 %r
+}
+
+define void @use(i32* %p) {
+  %v = load i32, i32* %p
+  %v2 = add i32 %v, 1
+  store i32 %v2, i32* %p
+  ret void
+}
+
+define i32 @cycle(i32 %n) {
+entry:
+  br label %loop
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %d = phi i32 [ 1, %entry ], [ %d.next, %loop ]
+  %d.next = mul i32 %d, 3
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %loop, label %out
+out:
+  ret i32 %i.next
+}
+
+define i32 @main() {
+  %a = call i32 @f(i32 4)
+  %b = call i32 @f(i32 10)
+  %c = call i32 @cycle(i32 5)
+  %d = sdiv i32 %a, 0
+  %fmt = getelementptr [10 x i8], [10 x i8]* @fmt, i32 0, i32 0
+  %x = call i32 (i8*, ...) @printf(i8* %fmt, i32 %a, i32 %b, i32 %c)
+  ret i32 0
+}
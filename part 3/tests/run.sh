@@ -0,0 +1,44 @@
+#!/bin/bash
+# run.sh <directory of the built passes> [tests...]
+#
+# each test loads the passes of its "; LOAD:" line and runs the ones of its "; RUN:" line.
+# it passes if the module is still valid, the statistics of -cse231-dfa-stats have its
+# "; STATS:" lines, and lli prints the same output and exit code before and after.
+
+passes=$1
+shift
+if [ $# -gt 0 ]; then
+	tests=("$@")
+else
+	tests=("$(dirname "$0")"/*.ll)
+fi
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+failed=0
+
+for test in "${tests[@]}"; do
+	name=$(basename "$test" .ll)
+	load=()
+	for so in $(sed -n 's/^; LOAD: //p' "$test"); do
+		load+=(-load "$passes/$so")
+	done
+	run=$(sed -n 's/^; RUN: //p' "$test")
+
+	if ! opt -enable-new-pm=0 "${load[@]}" $run -cse231-dfa-stats "$test" -o "$work/$name.bc" 2> "$work/$name.stats" ||
+			! opt -verify -disable-output "$work/$name.bc"; then
+		echo "FAIL $name: opt"
+		failed=1
+		continue
+	fi
+	ok=1
+	while IFS= read -r line; do
+		grep -qxF "$line" "$work/$name.stats" || { echo "FAIL $name: no \"$line\""; ok=0; }
+	done < <(sed -n 's/^; STATS: //p' "$test")
+
+	before=$(lli "$test" 2>&1; echo "exit $?")
+	after=$(lli "$work/$name.bc" 2>&1; echo "exit $?")
+	[ "$before" == "$after" ] || { echo "FAIL $name: output"; diff <(echo "$before") <(echo "$after"); ok=0; }
+
+	[ $ok == 1 ] && echo "PASS $name" || failed=1
+done
+exit $failed